@@ -0,0 +1,128 @@
+/**
+ * author: Harshit Kumar and Khushi Neema
+ * date: Oct 17, 2026
+ * purpose: Frames from a camera, a video file, a directory of images or a synthetic pattern.
+ *
+ */
+
+#ifndef FRAMESOURCE_H
+#define FRAMESOURCE_H
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+/** @brief Inner corners of the board drawn by the "chessboard" pattern, as project4 expects. */
+const cv::Size syntheticBoardSize(9, 6);
+
+/**
+ * @brief Where the frames come from and how fast they are delivered, usually taken
+ * from the command line by parseFrameSourceArgs().
+ *
+ * spec is one of:
+ *   "0", "camera:1"                  a camera by index
+ *   "file:clip.mp4", "clip.mp4"      a video file
+ *   "images:shots/", "shots/"        the images in a directory, in name order
+ *   "chessboard[:WxH[:frames]]"      a 9x6 chessboard turning in front of the camera
+ *   "blobs[:WxH[:frames]]"           dark shapes moving over a light table
+ *
+ * The synthetic patterns are 640x480 and 300 frames long unless given, 0 frames
+ * runs forever, and the same frame index always gives the same image.
+ */
+struct FrameSourceOptions
+{
+    std::string spec;
+    bool paced; // deliver files, images and patterns at their frame rate instead of as fast as possible
+
+    FrameSourceOptions(const std::string &spec = "0", bool paced = true) : spec(spec), paced(paced) {}
+};
+
+/**
+ * @brief A stream of BGR frames. A camera delivers at its own rate, the other
+ * sources either as fast as they are read or, when paced, no faster than their
+ * frame rate.
+ */
+class FrameSource
+{
+public:
+    FrameSource();
+    virtual ~FrameSource() {}
+
+    /**
+     * @brief Reads the next frame, waiting for its time first when the source is paced.
+     * @param frame Set to the frame, reusing its buffer when it has the right size and type.
+     * @return true if a frame was read, false at the end of the input or on a read error.
+     */
+    bool read(cv::Mat &frame);
+
+    /** @brief Turns real-time pacing on or off, a camera ignores it. */
+    void setPaced(bool on) { paced = on; }
+
+    /** @brief Frames per second of the source, the camera's or file's own when it reports one. */
+    virtual double fps() const = 0;
+
+    /** @brief Number of frames, -1 if unknown or endless. */
+    virtual double frameCount() const { return -1; }
+
+    /** @brief Frame size, (0, 0) if not known before the first frame. */
+    virtual cv::Size size() const = 0;
+
+    /** @brief What the frames come from, for log messages. */
+    virtual std::string describe() const = 0;
+
+    /** @brief Whether the source produces frames at its own rate (a camera). */
+    virtual bool isLive() const { return false; }
+
+protected:
+    /**
+     * @brief Reads frame number index into frame.
+     * @return true if a frame was read, false at the end of the input.
+     */
+    virtual bool next(cv::Mat &frame, size_t index) = 0;
+
+private:
+    bool paced;
+    size_t frames;
+    std::chrono::steady_clock::time_point start;
+
+    FrameSource(const FrameSource &);
+    FrameSource &operator=(const FrameSource &);
+};
+
+/**
+ * @brief Opens the source described by options.spec.
+ * @param options Source and pacing.
+ * @param source Set to the opened source.
+ * @param error If not NULL, set to the reason when the source cannot be opened.
+ * @return 0 if the operation is successful, -1 if the spec is invalid or the source cannot be opened.
+ */
+int openFrameSource(const FrameSourceOptions &options, std::unique_ptr<FrameSource> &source,
+                    std::string *error = NULL);
+
+/**
+ * @brief Takes "--source <spec>", "--paced" and "--fast" out of argv, leaving the
+ * other arguments in order for the program.
+ * @param argc Argument count, reduced by the arguments taken.
+ * @param argv Arguments, compacted.
+ * @param options Updated with the arguments found, its values are the defaults.
+ * @return 0 if the operation is successful, -1 if --source has no value.
+ */
+int parseFrameSourceArgs(int &argc, char **argv, FrameSourceOptions &options);
+
+/**
+ * @brief Like parseFrameSourceArgs(), for programs that read several sources: every
+ * "--source <spec>" adds one, and "--paced" / "--fast" apply to all of them.
+ * @param argc Argument count, reduced by the arguments taken.
+ * @param argv Arguments, compacted.
+ * @param sources Set to the sources given, in order; left alone if there are none.
+ * @param paced Pacing used unless "--paced" or "--fast" is given.
+ * @return 0 if the operation is successful, -1 if --source has no value.
+ */
+int parseFrameSourceArgs(int &argc, char **argv, std::vector<FrameSourceOptions> &sources, bool paced = true);
+
+/** @brief One-line usage of the source arguments, for the programs' help text. */
+const char *frameSourceUsage();
+
+#endif // FRAMESOURCE_H
@@ -0,0 +1,173 @@
+/**
+ * author: Harshit Kumar and Khushi Neema
+ * date: Oct 17, 2026
+ * purpose: Image kernels shared by the projects, picked for the CPU's instruction set at run time.
+ *
+ */
+
+#ifndef IMAGEKERNELS_H
+#define IMAGEKERNELS_H
+
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+/**
+ * @brief Row kernels of one instruction set. Every kernel works on n elements of
+ * interleaved pixels, so an image with cn channels is filtered as rows of cols * cn
+ * bytes, with neighbouring pixels cn bytes apart. Inputs may be unaligned, and the
+ * reads at s - k * cn and s + k * cn must lie inside the row.
+ *
+ * The scalar kernels are the passes of the blur and Sobel SeparableFilter instances
+ * (separableFilter.h). Every other implementation gives the same result to the bit,
+ * only the speed differs.
+ */
+struct ImageKernels
+{
+    /** @brief Name of the instruction set: "scalar", "sse4.1", "avx2" or "avx512". */
+    const char *isa;
+
+    /** @brief t = s[-2cn] + 2 s[-cn] + 4 s + 2 s[cn] + s[2cn], the row pass of blur5x5_2(). */
+    void (*blurRow)(const uchar *s, ushort *t, int n, int cn);
+
+    /** @brief d = (r0 + 2 r1 + 4 r2 + 2 r3 + r4 + 50) / 100 over five blurRow() outputs. */
+    void (*blurCol)(const ushort *const *rows, uchar *d, int n);
+
+    /** @brief d = trunc((b - a) / 2 + 0.5) wrapped to 8 bits, as the original double-precision Sobel filters did. */
+    void (*derivative)(const uchar *a, const uchar *b, uchar *d, int n);
+
+    /** @brief d = (a + 2 b + c + 2) / 4. */
+    void (*smooth3)(const uchar *a, const uchar *b, const uchar *c, short *d, int n);
+
+    /** @brief d = sqrt(x * x + y * y) rounded down, at most 255. */
+    void (*magnitude)(const short *x, const short *y, uchar *d, int n);
+};
+
+/**
+ * @brief Returns the kernels for the best instruction set this CPU supports among
+ * the ones the library was built with. The choice is made on the first call and can
+ * be capped with the IMAGE_KERNELS_ISA environment variable (scalar, sse4.1, avx2 or
+ * avx512), e.g. to compare the implementations.
+ * @return The kernel table, valid for the lifetime of the program.
+ */
+const ImageKernels &imageKernels();
+
+/**
+ * @brief Describes the dispatch for the programs' startup message, e.g.
+ * "avx2 (built: scalar sse4.1 avx2 avx512, cpu: sse4.1 avx2)".
+ * @return The description.
+ */
+std::string describeImageKernels();
+
+/**
+ * @brief Reusable scratch memory for the filters.
+ *
+ * The overloads taking a workspace get their row buffers (and the copy of the
+ * input they need when dst is the same image as src) from here instead of the
+ * heap. The memory grows to the largest size asked for and is then reused, so
+ * calling a filter again on frames of the same size, with a dst of the right
+ * size and type, does not allocate. A workspace must not be used by two calls
+ * at the same time; the overloads without one use a temporary workspace.
+ */
+class KernelWorkspace
+{
+public:
+    /**
+     * @brief Returns at least bytes of 64-byte aligned scratch memory. The
+     * contents are not kept from one call to the next.
+     */
+    uchar *scratch(size_t bytes);
+
+    /**
+     * @brief Image for a copy of the input, used when a filter's dst aliases its src.
+     */
+    cv::Mat &inputCopy() { return copy; }
+
+private:
+    std::vector<uchar> memory;
+    cv::Mat copy;
+};
+
+/**
+ * @brief Sets how many row bands (worker threads) the filters are split into.
+ * The output does not depend on this value, only the speed does.
+ * @param threads Number of threads, 1 for serial, 0 or less for OpenCV's default.
+ * @return The thread count now in effect.
+ */
+int setFilterThreads(int threads);
+
+/**
+ * @brief Returns the thread count used by the filters. Defaults to the
+ * IMAGE_KERNELS_THREADS environment variable, or OpenCV's thread count when unset.
+ * @return The thread count in effect.
+ */
+int getFilterThreads();
+
+/**
+ * @brief Sets the width of the column tiles the filters work through, one tile at a
+ * time down each row band. Narrower tiles keep the rolling row buffers in cache on very
+ * wide images. The output does not depend on this value, only the speed does.
+ * @param pixels Tile width in pixels, 0 to size the tiles from the L2 cache.
+ * @return The setting now in effect.
+ */
+int setFilterTileWidth(int pixels);
+
+/**
+ * @brief Returns the tile width setting. Defaults to the IMAGE_KERNELS_TILE_WIDTH
+ * environment variable, or 0 (sized from the cache) when unset.
+ * @return The tile width in pixels, 0 for automatic.
+ */
+int getFilterTileWidth();
+
+/**
+ * @brief Applies a 5x5 [1 2 4 2 1] blur to an image, normalized with rounding. The
+ * two-pixel border is black.
+ * @param src Input image (8-bit, any number of channels).
+ * @param dst Output image, may be the same Mat as src.
+ * @return 0 if the operation is successful, -1 if src is not 8-bit.
+ */
+int blur5x5_2(cv::Mat &src, cv::Mat &dst);
+
+/**
+ * @brief blur5x5_2() with its scratch memory taken from ws.
+ */
+int blur5x5_2(cv::Mat &src, cv::Mat &dst, KernelWorkspace &ws);
+
+/**
+ * @brief Applies a 3x3 Sobel X filter ([-1 0 1] across, then [1 2 1] down), each pass
+ * halved or quartered with rounding. The first and last rows are zero.
+ * @param src Input image (8-bit, any number of channels).
+ * @param dst Output image (CV_16S, as many channels as src).
+ * @return 0 if the operation is successful, -1 if src is not 8-bit.
+ */
+int sobelX3x3(cv::Mat &src, cv::Mat &dst);
+
+/**
+ * @brief sobelX3x3() with its scratch memory taken from ws.
+ */
+int sobelX3x3(cv::Mat &src, cv::Mat &dst, KernelWorkspace &ws);
+
+/**
+ * @brief Applies a 3x3 Sobel Y filter ([-1 0 1] down, then [1 2 1] across), each pass
+ * halved or quartered with rounding. The first and last columns are zero.
+ * @param src Input image (8-bit, any number of channels).
+ * @param dst Output image (CV_16S, as many channels as src).
+ * @return 0 if the operation is successful, -1 if src is not 8-bit.
+ */
+int sobelY3x3(cv::Mat &src, cv::Mat &dst);
+
+/**
+ * @brief sobelY3x3() with its scratch memory taken from ws.
+ */
+int sobelY3x3(cv::Mat &src, cv::Mat &dst, KernelWorkspace &ws);
+
+/**
+ * @brief Computes the gradient magnitude sqrt(x^2 + y^2) of two Sobel images, rounded
+ * down and saturated to 255.
+ * @param sobelX Input image (CV_16S, from sobelX3x3()).
+ * @param sobelY Input image (the type and size of sobelX).
+ * @param dst Output image (CV_8U, as many channels as the inputs).
+ * @return 0 if the operation is successful, -1 if the inputs are not CV_16S or differ in type or size.
+ */
+int magnitude(cv::Mat &sobelX, cv::Mat &sobelY, cv::Mat &dst);
+
+#endif // IMAGEKERNELS_H
@@ -0,0 +1,238 @@
+/**
+ * author: Harshit Kumar and Khushi Neema
+ * date: Oct 17, 2026
+ * purpose: Row bands and column tiles the image kernels run in, and the smoothing
+ * driver built on them, shared by the library and project1's filters.
+ *
+ */
+
+#ifndef KERNELBANDS_H
+#define KERNELBANDS_H
+
+// Only for files built with the project's own flags: the per-instruction-set files of
+// the library must not include this, their copies of the templates could be picked
+// for the scalar code.
+
+#include <algorithm>
+#include <cstring>
+#include <opencv2/opencv.hpp>
+#include "imageKernels.h"
+#include "separableFilter.h"
+
+/**
+ * @brief Number of row bands a frame with rows rows is split into, at most
+ * getFilterThreads() and with bands a few dozen rows tall.
+ */
+int bandCount(int rows);
+
+/**
+ * @brief Bytes of a row (out of n, cn bytes per pixel) a kernel processes per column
+ * tile when its buffers need scratchPerByte bytes for every byte of tile width. Whole
+ * rows unless the buffers would outgrow the cache budget, tiles are a multiple of 16 pixels.
+ */
+int tileBytes(int n, int cn, size_t scratchPerByte);
+
+/** @brief Per-band scratch blocks start on their own cache line. */
+inline size_t bandStride(size_t bytes)
+{
+    return (bytes + 63) & ~(size_t)63;
+}
+
+// Hands each band of a parallel_for_ range to body(band, rowBegin, rowEnd). A loop
+// body object rather than a lambda, so dispatching does not allocate a std::function.
+template <typename Body>
+class BandLoop : public cv::ParallelLoopBody
+{
+public:
+    BandLoop(const Body &body, int rows, int bands) : body(body), rows(rows), bands(bands) {}
+
+    void operator()(const cv::Range &range) const
+    {
+        for (int b = range.start; b < range.end; b++)
+        {
+            body(b, (int)((int64)rows * b / bands), (int)((int64)rows * (b + 1) / bands));
+        }
+    }
+
+private:
+    const Body &body;
+    int rows;
+    int bands;
+};
+
+// Runs body(band, rowBegin, rowEnd) over bands horizontal bands covering [0, rows) on
+// OpenCV's persistent worker pool. Each band reads whatever halo rows it needs straight
+// from the source, so the output is identical to a single body(0, 0, rows) call; band
+// (0 .. bands-1) selects the band's own scratch memory.
+template <typename Body>
+static void forEachBand(int rows, int bands, const Body &body)
+{
+    if (bands <= 1)
+    {
+        body(0, 0, rows);
+        return;
+    }
+    cv::parallel_for_(cv::Range(0, bands), BandLoop<Body>(body, rows, bands), bands);
+}
+
+// Same for kernels without per-band scratch: body(rowBegin, rowEnd)
+template <typename Body>
+static void forEachBand(int rows, const Body &body)
+{
+    forEachBand(rows, bandCount(rows), [&](int, int rowBegin, int rowEnd)
+    {
+        body(rowBegin, rowEnd);
+    });
+}
+
+typedef SeparableFilter<Taps<1, 2, 4, 2, 1>, Taps<1, 2, 4, 2, 1> > Blur5;
+
+// Row and column pass of a smoothing kernel, 16-bit sums in between. The generic
+// version is left to the compiler's vectorizer, the 5x5 blur uses the kernels picked
+// for the CPU.
+template <typename Filter>
+struct SmoothPasses
+{
+    static_assert(Filter::Row::sum * 255 <= 65535, "row sums must fit in 16 bits");
+
+    static void row(const uchar *s, ushort *t, int n, int cn)
+    {
+        Filter::rowPass(s, t, n, cn, typename Filter::template Sum<ushort>());
+    }
+
+    static void col(const ushort *const *rows, uchar *d, int n)
+    {
+        Filter::colPass(rows, d, n, typename Filter::Mean());
+    }
+};
+
+template <>
+struct SmoothPasses<Blur5>
+{
+    static void row(const uchar *s, ushort *t, int n, int cn)
+    {
+        imageKernels().blurRow(s, t, n, cn);
+    }
+
+    static void col(const ushort *const *rows, uchar *d, int n)
+    {
+        imageKernels().blurCol(rows, d, n);
+    }
+};
+
+// Applies a smoothing filter (non-negative taps, normalized) to an 8-bit image with any
+// number of channels, with every output row mapped through table (when not NULL) while
+// it is still in cache. A border as wide as the kernel radius stays black.
+template <typename Filter>
+static int smoothRows(cv::Mat &src, cv::Mat &dst, KernelWorkspace &ws, const uchar *table)
+{
+    if (src.depth() != CV_8U)
+    {
+        return -1;
+    }
+
+    // bands read halo rows from src while neighbouring bands write dst, so work from a
+    // copy when the two share data
+    cv::Mat input = src;
+    if (input.data == dst.data)
+    {
+        src.copyTo(ws.inputCopy());
+        input = ws.inputCopy();
+    }
+
+    const int cn = input.channels();
+    const int taps = Filter::Col::size;
+    const int radius = Filter::colRadius;
+    const int rows = input.rows;
+    const int cols = input.cols;
+    dst.create(input.size(), input.type());
+
+    if (rows < taps || cols < Filter::Row::size)
+    {
+        dst = cv::Scalar::all(0);
+        return 0;
+    }
+
+    const int width = cols * cn;
+    const int first = Filter::rowRadius * cn;  // first interior byte of a row
+    const int n = width - 2 * first;           // interior bytes per row
+
+    // the row filter runs radius rows ahead of the column filter through a ring of
+    // 16-bit sums per band, followed by one 8-bit row for the table lookup; on wide
+    // images the band is worked through one column tile at a time so the ring stays
+    // in cache
+    const int tile = tileBytes(n, cn, taps * sizeof(ushort) + (table ? 1 : 0));
+    const int bands = bandCount(rows);
+    const size_t ringBytes = bandStride(taps * tile * sizeof(ushort));
+    const size_t bandBytes = ringBytes + (table ? bandStride(tile) : 0);
+    uchar *rings = ws.scratch(bands * bandBytes);
+
+    forEachBand(rows, bands, [&](int band, int rowBegin, int rowEnd)
+    {
+        const int begin = std::max(rowBegin, radius);
+        const int end = std::min(rowEnd, rows - radius);
+        if (begin >= end)
+        {
+            return;
+        }
+
+        ushort *ring = (ushort *)(rings + band * bandBytes);
+        uchar *filtered = rings + band * bandBytes + ringBytes;
+        ushort *ringRows[taps];
+        for (int r = 0; r < taps; r++)
+        {
+            ringRows[r] = ring + r * tile;
+        }
+        const ushort *window[taps];
+
+        for (int x = first; x < first + n; x += tile)
+        {
+            const int w = std::min(tile, first + n - x);
+
+            // fill the ring starting from the band's halo rows above
+            for (int i = begin - radius; i < begin + radius; i++)
+            {
+                SmoothPasses<Filter>::row(input.ptr<uchar>(i) + x, ringRows[i % taps], w, cn);
+            }
+
+            for (int i = begin; i < end; i++)
+            {
+                // row filter for the row entering the window, then the column filter
+                // over the rows i - radius .. i + radius
+                SmoothPasses<Filter>::row(input.ptr<uchar>(i + radius) + x, ringRows[(i + radius) % taps], w, cn);
+                for (int r = 0; r < taps; r++)
+                {
+                    window[r] = ringRows[(i - radius + r) % taps];
+                }
+                uchar *dptr = dst.ptr<uchar>(i) + x;
+                SmoothPasses<Filter>::col(window, table ? filtered : dptr, w);
+                if (table)
+                {
+                    for (int k = 0; k < w; k++)
+                    {
+                        dptr[k] = table[filtered[k]];
+                    }
+                }
+            }
+        }
+
+        // the border columns stay black
+        for (int i = begin; i < end; i++)
+        {
+            uchar *dptr = dst.ptr<uchar>(i);
+            memset(dptr, 0, first);
+            memset(dptr + width - first, 0, first);
+        }
+    });
+
+    // the border rows stay black
+    for (int i = 0; i < radius; i++)
+    {
+        memset(dst.ptr<uchar>(i), 0, width);
+        memset(dst.ptr<uchar>(rows - 1 - i), 0, width);
+    }
+
+    return 0; // Success
+}
+
+#endif // KERNELBANDS_H
@@ -0,0 +1,135 @@
+/**
+ * author: Harshit Kumar and Khushi Neema
+ * date: Oct 17, 2026
+ * purpose: Compile-time separable convolution kernels (blur, Sobel, Gaussian), the scalar
+ * reference of the shared image kernels and project1's generic filters.
+ *
+ */
+
+#ifndef SEPARABLEFILTER_H
+#define SEPARABLEFILTER_H
+
+// tells the vectorizer that the rows a pass reads and the row it writes do not overlap,
+// so it does not have to guard the loop with run-time alias checks
+#if defined(__clang__)
+#define SEPARABLE_NO_ALIAS _Pragma("clang loop vectorize(assume_safety)")
+#elif defined(__GNUC__)
+#define SEPARABLE_NO_ALIAS _Pragma("GCC ivdep")
+#else
+#define SEPARABLE_NO_ALIAS
+#endif
+
+/**
+ * @brief A compile-time list of integer filter taps, e.g. Taps<1, 2, 4, 2, 1>.
+ *
+ * dot() and dotRows() expand to one multiply-add per tap with the tap as a
+ * constant, so zero taps disappear, taps of 1, 2, 4 become adds and shifts,
+ * and a loop calling them is plain enough for the compiler to vectorize.
+ */
+template <int... Values>
+struct Taps;
+
+template <>
+struct Taps<>
+{
+    static const int size = 0;
+    static const int sum = 0;
+
+    template <typename T>
+    static inline int dot(const T *, int) { return 0; }
+
+    template <typename T>
+    static inline int dotRows(const T *const *, int) { return 0; }
+};
+
+template <int First, int... Rest>
+struct Taps<First, Rest...>
+{
+    static const int size = 1 + sizeof...(Rest);
+    static const int sum = First + Taps<Rest...>::sum;
+
+    /**
+     * @brief First * s[0] + Rest[0] * s[step] + ... along a row.
+     */
+    template <typename T>
+    static inline int dot(const T *s, int step)
+    {
+        return First * s[0] + Taps<Rest...>::dot(s + step, step);
+    }
+
+    /**
+     * @brief First * rows[0][k] + Rest[0] * rows[1][k] + ... down a column.
+     */
+    template <typename T>
+    static inline int dotRows(const T *const *rows, int k)
+    {
+        return First * rows[0][k] + Taps<Rest...>::dotRows(rows + 1, k);
+    }
+};
+
+/**
+ * @brief A 2D kernel made of a horizontal and a vertical 1D kernel, e.g.
+ * SeparableFilter<Taps<-1, 0, 1>, Taps<1, 2, 1> > for Sobel X.
+ *
+ * The passes work on interleaved rows of any element type, n elements at a time
+ * with neighbouring pixels cn elements apart, and hand every sum to a store
+ * functor that turns it into the output type (scaling, rounding, clamping).
+ * The output must not overlap the rows read. Row buffering, borders and threading
+ * are left to the caller.
+ */
+template <typename RowTaps, typename ColTaps>
+struct SeparableFilter
+{
+    typedef RowTaps Row;
+    typedef ColTaps Col;
+
+    static const int rowRadius = RowTaps::size / 2;
+    static const int colRadius = ColTaps::size / 2;
+
+    /** @brief Sum of all 2D weights, the divisor of a normalized (mean) kernel. */
+    static const int norm = RowTaps::sum * ColTaps::sum;
+
+    /**
+     * @brief Horizontal pass: t[k] = store(sum over the taps of the pixels around s[k]).
+     * Reads rowRadius pixels on either side of s[0 .. n).
+     */
+    template <typename S, typename T, typename Store>
+    static void rowPass(const S *s, T *t, int n, int cn, Store store)
+    {
+        const S *first = s - rowRadius * cn;
+        SEPARABLE_NO_ALIAS
+        for (int k = 0; k < n; k++)
+        {
+            t[k] = store(RowTaps::dot(first + k, cn));
+        }
+    }
+
+    /**
+     * @brief Vertical pass: d[k] = store(sum over the taps of rows[0][k] .. rows[size - 1][k]).
+     * rows holds ColTaps::size row pointers from top to bottom.
+     */
+    template <typename S, typename T, typename Store>
+    static void colPass(const S *const *rows, T *d, int n, Store store)
+    {
+        SEPARABLE_NO_ALIAS
+        for (int k = 0; k < n; k++)
+        {
+            d[k] = store(ColTaps::dotRows(rows, k));
+        }
+    }
+
+    /** @brief Store functor that keeps the raw sum. */
+    template <typename T>
+    struct Sum
+    {
+        T operator()(int x) const { return static_cast<T>(x); }
+    };
+
+    /** @brief Store functor that divides by norm with rounding, for kernels with non-negative taps. */
+    struct Mean
+    {
+        unsigned char operator()(int x) const { return static_cast<unsigned char>((x + norm / 2) / norm); }
+    };
+};
+
+#endif // SEPARABLEFILTER_H
@@ -0,0 +1,524 @@
+/**
+ * author: Harshit Kumar and Khushi Neema
+ * date: Oct 17, 2026
+ * purpose: Frames from a camera, a video file, a directory of images or a synthetic pattern.
+ *
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <sys/stat.h>
+#include "frameSource.h"
+
+// rate of the sources that do not report one
+static const double defaultFps = 30.0;
+
+// size and length of the synthetic patterns when the spec does not give them
+static const cv::Size defaultPatternSize(640, 480);
+static const int defaultPatternFrames = 300;
+
+static const double twoPi = 6.283185307179586;
+
+FrameSource::FrameSource() : paced(false), frames(0)
+{
+}
+
+bool FrameSource::read(cv::Mat &frame)
+{
+    if (paced && !isLive())
+    {
+        // frame n is due n / fps seconds after the first one, so a slow reader does not drift
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (frames == 0)
+        {
+            start = now;
+        }
+        const std::chrono::duration<double> due(frames / fps());
+        std::this_thread::sleep_until(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(due));
+    }
+    if (!next(frame, frames))
+    {
+        return false;
+    }
+    frames++;
+    return true;
+}
+
+/*
+  A camera or a video file, both read through cv::VideoCapture.
+ */
+class CaptureSource : public FrameSource
+{
+public:
+    CaptureSource(const std::string &name, bool live) : name(name), live(live) {}
+
+    bool open(int device) { return capture.open(device); }
+    bool open(const std::string &path) { return capture.open(path); }
+
+    double fps() const
+    {
+        double rate = capture.get(cv::CAP_PROP_FPS);
+        return rate > 0 ? rate : defaultFps;
+    }
+
+    double frameCount() const
+    {
+        double count = live ? -1 : capture.get(cv::CAP_PROP_FRAME_COUNT);
+        return count > 0 ? count : -1;
+    }
+
+    cv::Size size() const
+    {
+        return cv::Size((int)capture.get(cv::CAP_PROP_FRAME_WIDTH), (int)capture.get(cv::CAP_PROP_FRAME_HEIGHT));
+    }
+
+    std::string describe() const { return name; }
+    bool isLive() const { return live; }
+
+protected:
+    bool next(cv::Mat &frame, size_t)
+    {
+        capture >> frame;
+        return !frame.empty();
+    }
+
+private:
+    // get() is not const in older OpenCV versions
+    mutable cv::VideoCapture capture;
+    std::string name;
+    bool live;
+};
+
+/*
+  The image files of a directory in name order, unreadable files are skipped.
+ */
+class ImageDirSource : public FrameSource
+{
+public:
+    ImageDirSource(const std::string &dir, const std::vector<std::string> &files) : dir(dir), files(files), pos(0)
+    {
+        first = cv::imread(files[0], cv::IMREAD_COLOR);
+    }
+
+    double fps() const { return defaultFps; }
+    double frameCount() const { return (double)files.size(); }
+    cv::Size size() const { return first.size(); }
+    std::string describe() const { return dir + " (" + std::to_string(files.size()) + " images)"; }
+
+protected:
+    bool next(cv::Mat &frame, size_t)
+    {
+        while (pos < files.size())
+        {
+            frame = cv::imread(files[pos++], cv::IMREAD_COLOR);
+            if (!frame.empty())
+            {
+                return true;
+            }
+            printf("Skipping unreadable image %s\n", files[pos - 1].c_str());
+        }
+        return false;
+    }
+
+private:
+    std::string dir;
+    std::vector<std::string> files;
+    size_t pos;
+    cv::Mat first;
+};
+
+/*
+  A synthetic pattern: frame n only depends on n, so runs are repeatable.
+ */
+class PatternSource : public FrameSource
+{
+public:
+    PatternSource(const std::string &name, cv::Size frameSize, int length)
+        : name(name), frameSize(frameSize), length(length)
+    {
+    }
+
+    double fps() const { return defaultFps; }
+    double frameCount() const { return length > 0 ? length : -1; }
+    cv::Size size() const { return frameSize; }
+
+    std::string describe() const
+    {
+        return name + " " + std::to_string(frameSize.width) + "x" + std::to_string(frameSize.height) + ", " +
+               (length > 0 ? std::to_string(length) + " frames" : std::string("endless"));
+    }
+
+protected:
+    bool next(cv::Mat &frame, size_t index)
+    {
+        if (length > 0 && index >= (size_t)length)
+        {
+            return false;
+        }
+        draw(frame, (double)index);
+        return true;
+    }
+
+    virtual void draw(cv::Mat &frame, double t) = 0;
+
+    std::string name;
+    cv::Size frameSize;
+    int length;
+};
+
+/*
+  A chessboard with syntheticBoardSize inner corners and a white margin, rotating
+  and sliding in front of a pinhole camera.
+ */
+class ChessboardSource : public PatternSource
+{
+public:
+    ChessboardSource(cv::Size frameSize, int length) : PatternSource("chessboard", frameSize, length)
+    {
+        const int square = 40;
+        const int squaresX = syntheticBoardSize.width + 1;
+        const int squaresY = syntheticBoardSize.height + 1;
+        board.create((squaresY + 2) * square, (squaresX + 2) * square, CV_8UC3);
+        board.setTo(cv::Scalar(255, 255, 255));
+        for (int i = 0; i < squaresY; i++)
+        {
+            for (int j = 0; j < squaresX; j++)
+            {
+                if ((i + j) % 2 == 0)
+                {
+                    cv::rectangle(board, cv::Rect((j + 1) * square, (i + 1) * square, square, square),
+                                  cv::Scalar(0, 0, 0), cv::FILLED);
+                }
+            }
+        }
+    }
+
+protected:
+    void draw(cv::Mat &frame, double t)
+    {
+        // slow, incommensurate swings, so the pose does not repeat for a long time
+        const double yaw = 0.5 * std::sin(twoPi * t / 120);
+        const double pitch = 0.35 * std::sin(twoPi * t / 170);
+        const double roll = 0.3 * std::sin(twoPi * t / 230);
+        const double focal = frameSize.width;
+        // the board is one unit wide and at this distance fills about half the frame
+        const double depth = 2.0 + 0.3 * std::sin(twoPi * t / 290);
+        const double shiftX = 0.15 * std::sin(twoPi * t / 200);
+        const double shiftY = 0.1 * std::sin(twoPi * t / 260);
+
+        const double cy = std::cos(yaw), sy = std::sin(yaw);
+        const double cp = std::cos(pitch), sp = std::sin(pitch);
+        const double cr = std::cos(roll), sr = std::sin(roll);
+        const double aspect = (double)board.rows / board.cols;
+        const cv::Point2f from[4] = {cv::Point2f(0, 0), cv::Point2f((float)board.cols, 0),
+                                     cv::Point2f((float)board.cols, (float)board.rows),
+                                     cv::Point2f(0, (float)board.rows)};
+        cv::Point2f to[4];
+        for (int k = 0; k < 4; k++)
+        {
+            // board corner on the z = 0 plane, centred on the origin
+            const double x = from[k].x / board.cols - 0.5;
+            const double y = (from[k].y / board.rows - 0.5) * aspect;
+            // rotate about x (pitch), then y (yaw), then z (roll)
+            const double y1 = y * cp, z1 = y * sp;
+            const double x2 = x * cy + z1 * sy, z2 = -x * sy + z1 * cy;
+            const double x3 = x2 * cr - y1 * sr, y3 = x2 * sr + y1 * cr;
+            const double z = depth + z2;
+            to[k] = cv::Point2f((float)(frameSize.width / 2 + focal * (x3 + shiftX) / z),
+                                (float)(frameSize.height / 2 + focal * (y3 + shiftY) / z));
+        }
+        cv::warpPerspective(board, frame, cv::getPerspectiveTransform(from, to), frameSize, cv::INTER_LINEAR,
+                            cv::BORDER_CONSTANT, cv::Scalar(90, 110, 120));
+    }
+
+private:
+    cv::Mat board;
+};
+
+/*
+  Dark shapes of different outlines moving over a light, slightly shaded table.
+ */
+class BlobsSource : public PatternSource
+{
+public:
+    BlobsSource(cv::Size frameSize, int length) : PatternSource("blobs", frameSize, length)
+    {
+        table.create(frameSize, CV_8UC3);
+        for (int i = 0; i < frameSize.height; i++)
+        {
+            const int shade = 215 + 20 * i / std::max(frameSize.height - 1, 1);
+            table.row(i).setTo(cv::Scalar(shade - 10, shade, shade));
+        }
+    }
+
+protected:
+    void draw(cv::Mat &frame, double t)
+    {
+        table.copyTo(frame);
+        const double w = frameSize.width, h = frameSize.height;
+        const double unit = std::min(w, h) / 10;
+
+        // each shape follows its own Lissajous path and turns as it goes
+        const cv::Point2f disc = path(t, 0.41, 0.0, 0.3, 0.22, 0.4);
+        cv::circle(frame, disc, (int)unit, cv::Scalar(40, 40, 40), cv::FILLED, cv::LINE_AA);
+
+        const cv::Point2f box = path(t, 0.29, 1.7, 0.23, 0.31, 2.1);
+        cv::RotatedRect boxShape(box, cv::Size2f((float)(2.4 * unit), (float)(1.2 * unit)), (float)(t * 1.5));
+        cv::Point2f boxCorners[4];
+        boxShape.points(boxCorners);
+        std::vector<cv::Point> boxPoly(boxCorners, boxCorners + 4);
+        cv::fillConvexPoly(frame, boxPoly, cv::Scalar(60, 30, 20), cv::LINE_AA);
+
+        const cv::Point2f oval = path(t, 0.37, 3.1, 0.19, 0.27, 4.4);
+        cv::ellipse(frame, cv::RotatedRect(oval, cv::Size2f((float)(2.6 * unit), (float)(1.1 * unit)), (float)(-t)),
+                    cv::Scalar(20, 50, 70), cv::FILLED, cv::LINE_AA);
+
+        const cv::Point2f tri = path(t, 0.23, 5.0, 0.35, 0.17, 1.2);
+        std::vector<cv::Point> triPoly(3);
+        for (int k = 0; k < 3; k++)
+        {
+            const double a = twoPi * k / 3 + t * 0.02;
+            triPoly[k] = cv::Point((int)(tri.x + 1.3 * unit * std::cos(a)), (int)(tri.y + 1.3 * unit * std::sin(a)));
+        }
+        cv::fillConvexPoly(frame, triPoly, cv::Scalar(30, 30, 80), cv::LINE_AA);
+    }
+
+private:
+    // position on a Lissajous curve inside the middle of the frame, speeds in cycles per 100 frames
+    cv::Point2f path(double t, double speedX, double phase, double rangeX, double rangeY, double speedY) const
+    {
+        const double x = 0.5 + rangeX * std::sin(twoPi * speedX * t / 100 + phase);
+        const double y = 0.5 + rangeY * std::sin(twoPi * speedY * t / 100 + 2 * phase);
+        return cv::Point2f((float)(x * frameSize.width), (float)(y * frameSize.height));
+    }
+
+    cv::Mat table;
+};
+
+static bool isNumber(const std::string &s)
+{
+    if (s.empty())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < s.size(); i++)
+    {
+        if (!isdigit((unsigned char)s[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool isDirectory(const std::string &path)
+{
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 && (info.st_mode & S_IFDIR) != 0;
+}
+
+static bool hasImageExtension(const std::string &path)
+{
+    static const char *extensions[] = {".jpg", ".jpeg", ".png", ".bmp", ".tif", ".tiff", ".ppm", ".pgm"};
+    const size_t dot = path.rfind('.');
+    if (dot == std::string::npos)
+    {
+        return false;
+    }
+    std::string ext = path.substr(dot);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    for (size_t i = 0; i < sizeof(extensions) / sizeof(extensions[0]); i++)
+    {
+        if (ext == extensions[i])
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// "WxH[:frames]" after a pattern name, both parts optional
+static int parsePatternArgs(const std::string &args, cv::Size &size, int &length)
+{
+    size = defaultPatternSize;
+    length = defaultPatternFrames;
+    if (args.empty())
+    {
+        return 0;
+    }
+    const size_t colon = args.find(':');
+    const std::string dims = args.substr(0, colon);
+    const size_t x = dims.find('x');
+    if (x == std::string::npos || !isNumber(dims.substr(0, x)) || !isNumber(dims.substr(x + 1)))
+    {
+        return -1;
+    }
+    size = cv::Size(atoi(dims.c_str()), atoi(dims.c_str() + x + 1));
+    if (size.width < 16 || size.height < 16)
+    {
+        return -1;
+    }
+    if (colon != std::string::npos)
+    {
+        const std::string count = args.substr(colon + 1);
+        if (!isNumber(count))
+        {
+            return -1;
+        }
+        length = atoi(count.c_str());
+    }
+    return 0;
+}
+
+static int fail(std::string *error, const std::string &message)
+{
+    if (error)
+    {
+        *error = message;
+    }
+    return -1;
+}
+
+int openFrameSource(const FrameSourceOptions &options, std::unique_ptr<FrameSource> &source, std::string *error)
+{
+    const std::string &spec = options.spec;
+    const size_t colon = spec.find(':');
+    const std::string kind = spec.substr(0, colon);
+    const std::string rest = colon == std::string::npos ? "" : spec.substr(colon + 1);
+
+    if (isNumber(spec) || kind == "camera")
+    {
+        const std::string index = isNumber(spec) ? spec : rest;
+        if (!isNumber(index))
+        {
+            return fail(error, "camera needs a device index, e.g. camera:0");
+        }
+        CaptureSource *camera = new CaptureSource("camera " + index, true);
+        source.reset(camera);
+        if (!camera->open(atoi(index.c_str())))
+        {
+            return fail(error, "unable to open camera " + index);
+        }
+    }
+    else if (kind == "chessboard" || kind == "blobs")
+    {
+        cv::Size size;
+        int length;
+        if (parsePatternArgs(rest, size, length) != 0)
+        {
+            return fail(error, "expected " + kind + "[:WIDTHxHEIGHT[:FRAMES]], got \"" + spec + "\"");
+        }
+        if (kind == "chessboard")
+        {
+            source.reset(new ChessboardSource(size, length));
+        }
+        else
+        {
+            source.reset(new BlobsSource(size, length));
+        }
+    }
+    else if (kind == "images" || (kind != "file" && isDirectory(spec)))
+    {
+        const std::string dir = kind == "images" ? rest : spec;
+        std::vector<cv::String> found;
+        cv::glob(dir, found, false);
+        std::vector<std::string> files;
+        for (size_t i = 0; i < found.size(); i++)
+        {
+            if (hasImageExtension(found[i]))
+            {
+                files.push_back(found[i]);
+            }
+        }
+        if (files.empty())
+        {
+            return fail(error, "no images in " + dir);
+        }
+        std::sort(files.begin(), files.end());
+        source.reset(new ImageDirSource(dir, files));
+    }
+    else
+    {
+        const std::string path = kind == "file" ? rest : spec;
+        CaptureSource *file = new CaptureSource(path, false);
+        source.reset(file);
+        if (path.empty() || !file->open(path))
+        {
+            return fail(error, "unable to open video file \"" + path + "\"");
+        }
+    }
+    source->setPaced(options.paced);
+    return 0;
+}
+
+int parseFrameSourceArgs(int &argc, char **argv, std::vector<FrameSourceOptions> &sources, bool paced)
+{
+    std::vector<std::string> specs;
+    int kept = 1;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--source") == 0)
+        {
+            if (i + 1 >= argc)
+            {
+                return -1;
+            }
+            specs.push_back(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--paced") == 0)
+        {
+            paced = true;
+        }
+        else if (strcmp(argv[i], "--fast") == 0)
+        {
+            paced = false;
+        }
+        else
+        {
+            argv[kept++] = argv[i];
+        }
+    }
+    argc = kept;
+    argv[argc] = NULL;
+
+    if (!specs.empty())
+    {
+        sources.clear();
+        for (size_t i = 0; i < specs.size(); i++)
+        {
+            sources.push_back(FrameSourceOptions(specs[i], paced));
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < sources.size(); i++)
+        {
+            sources[i].paced = paced;
+        }
+    }
+    return 0;
+}
+
+int parseFrameSourceArgs(int &argc, char **argv, FrameSourceOptions &options)
+{
+    // the last --source wins
+    std::vector<FrameSourceOptions> sources(1, options);
+    if (parseFrameSourceArgs(argc, argv, sources, options.paced) != 0)
+    {
+        return -1;
+    }
+    options = sources.back();
+    return 0;
+}
+
+const char *frameSourceUsage()
+{
+    return "[--source <camera index | camera:N | video file | image directory | chessboard[:WxH[:frames]] | "
+           "blobs[:WxH[:frames]]>] [--paced | --fast]";
+}
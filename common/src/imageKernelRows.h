@@ -0,0 +1,31 @@
+/**
+ * author: Harshit Kumar and Khushi Neema
+ * date: Oct 17, 2026
+ * purpose: Internals of the image kernels shared by the files of the different instruction sets.
+ *
+ */
+
+#ifndef IMAGEKERNELROWS_H
+#define IMAGEKERNELROWS_H
+
+#include "imageKernels.h"
+
+// kernel tables of the instruction sets other than scalar, each in its own file built with
+// that set enabled (see CMakeLists.txt)
+extern const ImageKernels sse41Kernels;
+extern const ImageKernels avx2Kernels;
+extern const ImageKernels avx512Kernels;
+
+// The scalar kernels, the reference every instruction set must match to the bit.
+// Each starts at element k, so a vector loop can hand it the elements it left
+// over. They are defined in imageKernels.cpp, the one file built without extra
+// instruction sets: the SeparableFilter instantiations they use must not be compiled
+// into the other files, or the linker could pick an AVX copy for the scalar kernels.
+
+void blurRowFrom(int k, const uchar *s, ushort *t, int n, int cn);
+void blurColFrom(int k, const ushort *const *rows, uchar *d, int n);
+void derivativeFrom(int k, const uchar *a, const uchar *b, uchar *d, int n);
+void smooth3From(int k, const uchar *a, const uchar *b, const uchar *c, short *d, int n);
+void magnitudeFrom(int k, const short *x, const short *y, uchar *d, int n);
+
+#endif // IMAGEKERNELROWS_H
@@ -0,0 +1,465 @@
+/**
+ * author: Harshit Kumar and Khushi Neema
+ * date: Oct 17, 2026
+ * purpose: Image kernels shared by the projects, picked for the CPU's instruction set at run time.
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+#include "imageKernels.h"
+#include "imageKernelRows.h"
+#include "kernelBands.h"
+
+// trunc(x / D + 0.5) in integers, the rounding of the original double-precision Sobel filters
+template <int D, typename T>
+struct RoundDiv
+{
+    T operator()(int x) const { return static_cast<T>((2 * x + D) / (2 * D)); }
+};
+
+// the reference kernels are these filters' passes (Blur5 is in kernelBands.h)
+typedef SeparableFilter<Taps<-1, 0, 1>, Taps<1, 2, 1> > SobelX; // derivative across, smoothing down
+typedef SeparableFilter<Taps<1, 2, 1>, Taps<-1, 0, 1> > SobelY; // smoothing across, derivative down
+
+void blurRowFrom(int k, const uchar *s, ushort *t, int n, int cn)
+{
+    Blur5::rowPass(s + k, t + k, n - k, cn, Blur5::Sum<ushort>());
+}
+
+void blurColFrom(int k, const ushort *const *rows, uchar *d, int n)
+{
+    const ushort *window[5] = {rows[0] + k, rows[1] + k, rows[2] + k, rows[3] + k, rows[4] + k};
+    Blur5::colPass(window, d + k, n - k, Blur5::Mean());
+}
+
+// SobelY's vertical pass, the [-1 0 1] taps never read the middle row. sobelX3x3() uses it
+// across a row as well, with a and b the neighbouring pixels.
+void derivativeFrom(int k, const uchar *a, const uchar *b, uchar *d, int n)
+{
+    const uchar *window[3] = {a + k, a + k, b + k};
+    SobelY::colPass(window, d + k, n - k, RoundDiv<2, uchar>());
+}
+
+// SobelX's vertical pass, sobelY3x3() uses it across a row as well
+void smooth3From(int k, const uchar *a, const uchar *b, const uchar *c, short *d, int n)
+{
+    const uchar *window[3] = {a + k, b + k, c + k};
+    SobelX::colPass(window, d + k, n - k, RoundDiv<4, short>());
+}
+
+void magnitudeFrom(int k, const short *x, const short *y, uchar *d, int n)
+{
+    for (; k < n; k++)
+    {
+        // float is exact wherever it matters: every sum below 2^16 is, larger ones saturate
+        const float m = std::sqrt((float)x[k] * x[k] + (float)y[k] * y[k]);
+        d[k] = m >= 255.0f ? 255 : static_cast<uchar>(m);
+    }
+}
+
+static void scalarBlurRow(const uchar *s, ushort *t, int n, int cn)
+{
+    blurRowFrom(0, s, t, n, cn);
+}
+
+static void scalarBlurCol(const ushort *const *rows, uchar *d, int n)
+{
+    blurColFrom(0, rows, d, n);
+}
+
+static void scalarDerivative(const uchar *a, const uchar *b, uchar *d, int n)
+{
+    derivativeFrom(0, a, b, d, n);
+}
+
+static void scalarSmooth3(const uchar *a, const uchar *b, const uchar *c, short *d, int n)
+{
+    smooth3From(0, a, b, c, d, n);
+}
+
+static void scalarMagnitude(const short *x, const short *y, uchar *d, int n)
+{
+    magnitudeFrom(0, x, y, d, n);
+}
+
+static const ImageKernels scalarKernels = {
+    "scalar", scalarBlurRow, scalarBlurCol, scalarDerivative, scalarSmooth3, scalarMagnitude};
+
+// Whether the CPU (and the OS, for the wider registers) supports an instruction set
+static bool cpuSupports(const std::string &isa)
+{
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    __builtin_cpu_init();
+    if (isa == "sse4.1")
+    {
+        return __builtin_cpu_supports("sse4.1");
+    }
+    if (isa == "avx2")
+    {
+        return __builtin_cpu_supports("avx2");
+    }
+    if (isa == "avx512")
+    {
+        // the 16-bit arithmetic the kernels use is in AVX-512BW
+        return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+    }
+#endif
+    return isa == "scalar";
+}
+
+// The tables this build has, best first
+static std::vector<const ImageKernels *> builtKernels()
+{
+    std::vector<const ImageKernels *> built;
+#ifdef IMAGE_KERNELS_AVX512
+    built.push_back(&avx512Kernels);
+#endif
+#ifdef IMAGE_KERNELS_AVX2
+    built.push_back(&avx2Kernels);
+#endif
+#ifdef IMAGE_KERNELS_SSE41
+    built.push_back(&sse41Kernels);
+#endif
+    built.push_back(&scalarKernels);
+    return built;
+}
+
+// The best table the CPU runs, no better than the one named by IMAGE_KERNELS_ISA
+static const ImageKernels *selectKernels()
+{
+    const std::vector<const ImageKernels *> built = builtKernels();
+    const char *cap = getenv("IMAGE_KERNELS_ISA");
+    bool allowed = true;
+    if (cap)
+    {
+        // an unknown name caps nothing
+        allowed = std::none_of(built.begin(), built.end(), [&](const ImageKernels *k) { return cap == std::string(k->isa); });
+    }
+    for (size_t i = 0; i < built.size(); i++)
+    {
+        allowed = allowed || cap == std::string(built[i]->isa);
+        if (allowed && cpuSupports(built[i]->isa))
+        {
+            return built[i];
+        }
+    }
+    return &scalarKernels;
+}
+
+const ImageKernels &imageKernels()
+{
+    static const ImageKernels *selected = selectKernels();
+    return *selected;
+}
+
+std::string describeImageKernels()
+{
+    const std::vector<const ImageKernels *> built = builtKernels();
+    std::string names, supported;
+    for (size_t i = built.size(); i-- > 0;)
+    {
+        names += std::string(names.empty() ? "" : " ") + built[i]->isa;
+    }
+    const char *all[] = {"sse4.1", "avx2", "avx512"};
+    for (size_t i = 0; i < sizeof(all) / sizeof(all[0]); i++)
+    {
+        if (cpuSupports(all[i]))
+        {
+            supported += std::string(supported.empty() ? "" : " ") + all[i];
+        }
+    }
+    std::string text = std::string(imageKernels().isa) + " (built: " + names + ", cpu: " +
+                       (supported.empty() ? "none" : supported) + ")";
+    const char *cap = getenv("IMAGE_KERNELS_ISA");
+    if (cap)
+    {
+        text += std::string(", IMAGE_KERNELS_ISA=") + cap;
+    }
+    return text;
+}
+
+// number of row bands the filters are split into, 0 until first use
+static std::atomic<int> filterThreads(0);
+
+int setFilterThreads(int threads)
+{
+    if (threads <= 0)
+    {
+        // back to OpenCV's default pool size
+        cv::setNumThreads(-1);
+        threads = cv::getNumThreads();
+    }
+    else
+    {
+        cv::setNumThreads(threads);
+    }
+    filterThreads = std::max(1, threads);
+    return filterThreads;
+}
+
+int getFilterThreads()
+{
+    if (filterThreads == 0)
+    {
+        // without the variable, go with whatever pool size the program has set up
+        const char *env = getenv("IMAGE_KERNELS_THREADS");
+        if (env)
+        {
+            setFilterThreads(atoi(env));
+        }
+        else
+        {
+            filterThreads = std::max(1, cv::getNumThreads());
+        }
+    }
+    return filterThreads;
+}
+
+int bandCount(int rows)
+{
+    // keep bands at least a few dozen rows tall so small frames don't pay for the fan-out
+    const int minBandRows = 32;
+    return std::max(1, std::min(getFilterThreads(), rows / minBandRows));
+}
+
+// column tile width in pixels, 0 for automatic, -1 until first use
+static std::atomic<int> filterTileWidth(-1);
+
+int setFilterTileWidth(int pixels)
+{
+    filterTileWidth = std::max(0, pixels);
+    return filterTileWidth;
+}
+
+int getFilterTileWidth()
+{
+    if (filterTileWidth < 0)
+    {
+        const char *env = getenv("IMAGE_KERNELS_TILE_WIDTH");
+        setFilterTileWidth(env ? atoi(env) : 0);
+    }
+    return filterTileWidth;
+}
+
+// Scratch a band's row buffers may take up before rows are split into tiles: half of the
+// L2 cache, the other half is left for the input and output rows streaming through
+static size_t tileBudget()
+{
+    static const size_t budget = []
+    {
+        long l2 = 0;
+#ifdef _SC_LEVEL2_CACHE_SIZE
+        l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+        return (size_t)(l2 > 0 ? l2 : 256 * 1024) / 2;
+    }();
+    return budget;
+}
+
+int tileBytes(int n, int cn, size_t scratchPerByte)
+{
+    const int pixels = getFilterTileWidth();
+    size_t bytes = pixels > 0 ? (size_t)pixels * cn : tileBudget() / scratchPerByte;
+    const size_t step = 16 * cn;
+    bytes = std::max(step, bytes / step * step);
+    return (int)std::min(bytes, (size_t)std::max(n, 1));
+}
+
+uchar *KernelWorkspace::scratch(size_t bytes)
+{
+    if (memory.size() < bytes + 64)
+    {
+        memory.resize(bytes + 64);
+    }
+    return cv::alignPtr(memory.data(), 64);
+}
+
+int blur5x5_2(cv::Mat &src, cv::Mat &dst)
+{
+    KernelWorkspace ws;
+    return blur5x5_2(src, dst, ws);
+}
+
+int blur5x5_2(cv::Mat &src, cv::Mat &dst, KernelWorkspace &ws)
+{
+    return smoothRows<Blur5>(src, dst, ws, NULL);
+}
+
+int sobelX3x3(cv::Mat &src, cv::Mat &dst)
+{
+    KernelWorkspace ws;
+    return sobelX3x3(src, dst, ws);
+}
+
+int sobelX3x3(cv::Mat &src, cv::Mat &dst, KernelWorkspace &ws)
+{
+    if (src.depth() != CV_8U)
+    {
+        return -1;
+    }
+
+    // keep a handle on the input, dst may be the same Mat as src
+    cv::Mat input = src;
+    const int cn = input.channels();
+    dst.create(input.size(), CV_MAKETYPE(CV_16S, cn));
+    if (input.empty())
+    {
+        return 0;
+    }
+
+    // the vertical pass reads three horizontally filtered rows, kept in a 3-row ring per
+    // band that is one column tile wide
+    const ImageKernels &kernels = imageKernels();
+    const int width = input.cols * cn;
+    const int tile = tileBytes(width, cn, 3) / cn;
+    const int bands = bandCount(input.rows);
+    const size_t ringBytes = bandStride(3 * tile * cn);
+    uchar *rings = ws.scratch(bands * ringBytes);
+
+    forEachBand(input.rows, bands, [&](int band, int rowBegin, int rowEnd)
+    {
+        const int begin = std::max(rowBegin, 1);
+        const int end = std::min(rowEnd, input.rows - 1);
+        if (begin >= end)
+        {
+            return;
+        }
+        uchar *ring = rings + band * ringBytes;
+
+        for (int x = 0; x < input.cols; x += tile)
+        {
+            const int w = std::min(tile, input.cols - x);
+
+            // horizontal filter of columns [x, x + w) of row i into the ring (the first
+            // and last columns keep the input)
+            auto horizontal = [&](int i)
+            {
+                uchar *tempptr = ring + (i % 3) * tile * cn;
+                const uchar *rowptr = input.ptr<uchar>(i);
+                if (x == 0)
+                {
+                    memcpy(tempptr, rowptr, cn);
+                }
+                if (x + w == input.cols)
+                {
+                    memcpy(tempptr + cn * (w - 1), rowptr + cn * (input.cols - 1), cn);
+                }
+                const int j0 = std::max(x, 1);
+                const int j1 = std::min(x + w, input.cols - 1);
+                if (j0 < j1)
+                {
+                    kernels.derivative(rowptr + cn * (j0 - 1), rowptr + cn * (j0 + 1), tempptr + cn * (j0 - x),
+                                       cn * (j1 - j0));
+                }
+            };
+
+            horizontal(begin - 1);
+            horizontal(begin);
+
+            // vertical filter
+            for (int i = begin; i < end; i++)
+            {
+                horizontal(i + 1);
+                kernels.smooth3(ring + ((i - 1) % 3) * tile * cn, ring + (i % 3) * tile * cn,
+                                ring + ((i + 1) % 3) * tile * cn, dst.ptr<short>(i) + cn * x, cn * w);
+            }
+        }
+    });
+
+    // first and last rows stay zero
+    memset(dst.ptr<short>(0), 0, width * sizeof(short));
+    memset(dst.ptr<short>(input.rows - 1), 0, width * sizeof(short));
+
+    return 0;
+}
+
+int sobelY3x3(cv::Mat &src, cv::Mat &dst)
+{
+    KernelWorkspace ws;
+    return sobelY3x3(src, dst, ws);
+}
+
+int sobelY3x3(cv::Mat &src, cv::Mat &dst, KernelWorkspace &ws)
+{
+    if (src.depth() != CV_8U)
+    {
+        return -1;
+    }
+
+    // keep a handle on the input, dst may be the same Mat as src
+    cv::Mat input = src;
+    const int cn = input.channels();
+    dst.create(input.size(), CV_MAKETYPE(CV_16S, cn));
+    if (input.empty())
+    {
+        return 0;
+    }
+
+    // the horizontal pass only reads the current row, so one temp row per band is enough
+    const ImageKernels &kernels = imageKernels();
+    const int width = input.cols * cn;
+    const int bands = bandCount(input.rows);
+    const size_t rowBytes = bandStride(width);
+    uchar *temps = ws.scratch(bands * rowBytes);
+
+    forEachBand(input.rows, bands, [&](int band, int rowBegin, int rowEnd)
+    {
+        uchar *tempptr = temps + band * rowBytes;
+
+        for (int i = rowBegin; i < rowEnd; i++)
+        {
+            // vertical filter (the first and last rows are passed through unfiltered)
+            if (i == 0 || i == input.rows - 1)
+            {
+                memcpy(tempptr, input.ptr<uchar>(i), width);
+            }
+            else
+            {
+                kernels.derivative(input.ptr<uchar>(i - 1), input.ptr<uchar>(i + 1), tempptr, width);
+            }
+
+            // horizontal filter (the first and last columns stay zero)
+            short *dptr = dst.ptr<short>(i);
+            if (input.cols > 2)
+            {
+                kernels.smooth3(tempptr, tempptr + cn, tempptr + 2 * cn, dptr + cn, width - 2 * cn);
+            }
+            memset(dptr, 0, cn * sizeof(short));
+            memset(dptr + width - cn, 0, cn * sizeof(short));
+        }
+    });
+
+    return 0;
+}
+
+int magnitude(cv::Mat &sobelX, cv::Mat &sobelY, cv::Mat &dst)
+{
+    if (sobelX.depth() != CV_16S || sobelX.type() != sobelY.type() || sobelX.size() != sobelY.size())
+    {
+        return -1;
+    }
+
+    // keep handles on the inputs, dst may be the same Mat as either; every pixel is written below
+    cv::Mat x = sobelX, y = sobelY;
+    dst.create(x.size(), CV_MAKETYPE(CV_8U, x.channels()));
+    const ImageKernels &k = imageKernels();
+    const int width = x.cols * x.channels();
+
+    forEachBand(x.rows, [&](int rowBegin, int rowEnd)
+    {
+        for (int i = rowBegin; i < rowEnd; i++)
+        {
+            k.magnitude(x.ptr<short>(i), y.ptr<short>(i), dst.ptr<uchar>(i), width);
+        }
+    });
+    return 0;
+}
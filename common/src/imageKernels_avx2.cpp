@@ -0,0 +1,111 @@
+/**
+ * author: Harshit Kumar and Khushi Neema
+ * date: Oct 17, 2026
+ * purpose: AVX2 image kernels, built with -mavx2 and only run on CPUs that have it.
+ *
+ */
+
+#include <immintrin.h>
+#include "imageKernelRows.h"
+
+// 16 words to 16 bytes in order; packus works per 128-bit lane, so the halves are put back afterwards
+static inline __m128i packBytes(__m256i v)
+{
+    return _mm256_castsi256_si128(_mm256_permute4x64_epi64(_mm256_packus_epi16(v, v), 0x08));
+}
+
+static void blurRow(const uchar *s, ushort *t, int n, int cn)
+{
+    int k = 0;
+    for (; k <= n - 16; k += 16)
+    {
+        __m256i m2 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(s + k - 2 * cn)));
+        __m256i m1 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(s + k - cn)));
+        __m256i c0 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(s + k)));
+        __m256i p1 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(s + k + cn)));
+        __m256i p2 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(s + k + 2 * cn)));
+        __m256i sum = _mm256_add_epi16(_mm256_add_epi16(m2, p2),
+                                       _mm256_slli_epi16(_mm256_add_epi16(_mm256_add_epi16(m1, p1), _mm256_slli_epi16(c0, 1)), 1));
+        _mm256_storeu_si256((__m256i *)(t + k), sum);
+    }
+    blurRowFrom(k, s, t, n, cn);
+}
+
+// The largest sum is 255 * 100 + 50, so (x * 41944) >> 22 is an exact x / 100 for every input.
+static void blurCol(const ushort *const *rows, uchar *d, int n)
+{
+    const __m256i half = _mm256_set1_epi16(50);
+    const __m256i recip = _mm256_set1_epi16((short)41944);
+    int k = 0;
+    for (; k <= n - 16; k += 16)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(rows[0] + k));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(rows[1] + k));
+        __m256i c = _mm256_loadu_si256((const __m256i *)(rows[2] + k));
+        __m256i e = _mm256_loadu_si256((const __m256i *)(rows[3] + k));
+        __m256i f = _mm256_loadu_si256((const __m256i *)(rows[4] + k));
+        __m256i sum = _mm256_add_epi16(_mm256_add_epi16(a, f),
+                                       _mm256_slli_epi16(_mm256_add_epi16(_mm256_add_epi16(b, e), _mm256_slli_epi16(c, 1)), 1));
+        sum = _mm256_srli_epi16(_mm256_mulhi_epu16(_mm256_add_epi16(sum, half), recip), 6);
+        _mm_storeu_si128((__m128i *)(d + k), packBytes(sum));
+    }
+    blurColFrom(k, rows, d, n);
+}
+
+// trunc((b - a + 1) / 2): the arithmetic shift rounds down, so negative values get one added first
+static void derivative(const uchar *a, const uchar *b, uchar *d, int n)
+{
+    const __m256i one = _mm256_set1_epi16(1);
+    const __m256i lowByte = _mm256_set1_epi16(0xff);
+    int k = 0;
+    for (; k <= n - 16; k += 16)
+    {
+        __m256i v = _mm256_add_epi16(_mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(b + k))),
+                                                      _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(a + k)))),
+                                     one);
+        v = _mm256_srai_epi16(_mm256_add_epi16(v, _mm256_srli_epi16(v, 15)), 1);
+        // keep the low byte, wrapping negative values like the cast to uchar
+        _mm_storeu_si128((__m128i *)(d + k), packBytes(_mm256_and_si256(v, lowByte)));
+    }
+    derivativeFrom(k, a, b, d, n);
+}
+
+static void smooth3(const uchar *a, const uchar *b, const uchar *c, short *d, int n)
+{
+    const __m256i two = _mm256_set1_epi16(2);
+    int k = 0;
+    for (; k <= n - 16; k += 16)
+    {
+        __m256i l = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(a + k)));
+        __m256i m = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(b + k)));
+        __m256i r = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(c + k)));
+        __m256i sum = _mm256_add_epi16(_mm256_add_epi16(l, r), _mm256_add_epi16(_mm256_slli_epi16(m, 1), two));
+        _mm256_storeu_si256((__m256i *)(d + k), _mm256_srli_epi16(sum, 2));
+    }
+    smooth3From(k, a, b, c, d, n);
+}
+
+// sqrt of eight 16-bit x, y pairs in float, truncated to 32-bit integers
+static inline __m256i magnitude8(__m128i x, __m128i y)
+{
+    __m256 fx = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(x));
+    __m256 fy = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(y));
+    return _mm256_cvttps_epi32(_mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(fx, fx), _mm256_mul_ps(fy, fy))));
+}
+
+static void magnitudeRow(const short *x, const short *y, uchar *d, int n)
+{
+    int k = 0;
+    for (; k <= n - 16; k += 16)
+    {
+        __m256i lo = magnitude8(_mm_loadu_si128((const __m128i *)(x + k)), _mm_loadu_si128((const __m128i *)(y + k)));
+        __m256i hi = magnitude8(_mm_loadu_si128((const __m128i *)(x + k + 8)),
+                                _mm_loadu_si128((const __m128i *)(y + k + 8)));
+        // both packs saturate, which caps the result at 255
+        __m256i m = _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xd8);
+        _mm_storeu_si128((__m128i *)(d + k), packBytes(m));
+    }
+    magnitudeFrom(k, x, y, d, n);
+}
+
+extern const ImageKernels avx2Kernels = {"avx2", blurRow, blurCol, derivative, smooth3, magnitudeRow};
@@ -0,0 +1,97 @@
+/**
+ * author: Harshit Kumar and Khushi Neema
+ * date: Oct 17, 2026
+ * purpose: AVX-512 image kernels, built with -mavx512f -mavx512bw and only run on CPUs that have both.
+ *
+ */
+
+#include <immintrin.h>
+#include "imageKernelRows.h"
+
+static void blurRow(const uchar *s, ushort *t, int n, int cn)
+{
+    int k = 0;
+    for (; k <= n - 32; k += 32)
+    {
+        __m512i m2 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((const __m256i *)(s + k - 2 * cn)));
+        __m512i m1 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((const __m256i *)(s + k - cn)));
+        __m512i c0 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((const __m256i *)(s + k)));
+        __m512i p1 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((const __m256i *)(s + k + cn)));
+        __m512i p2 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((const __m256i *)(s + k + 2 * cn)));
+        __m512i sum = _mm512_add_epi16(_mm512_add_epi16(m2, p2),
+                                       _mm512_slli_epi16(_mm512_add_epi16(_mm512_add_epi16(m1, p1), _mm512_slli_epi16(c0, 1)), 1));
+        _mm512_storeu_si512((void *)(t + k), sum);
+    }
+    blurRowFrom(k, s, t, n, cn);
+}
+
+// The largest sum is 255 * 100 + 50, so (x * 41944) >> 22 is an exact x / 100 for every input.
+static void blurCol(const ushort *const *rows, uchar *d, int n)
+{
+    const __m512i half = _mm512_set1_epi16(50);
+    const __m512i recip = _mm512_set1_epi16((short)41944);
+    int k = 0;
+    for (; k <= n - 32; k += 32)
+    {
+        __m512i a = _mm512_loadu_si512((const void *)(rows[0] + k));
+        __m512i b = _mm512_loadu_si512((const void *)(rows[1] + k));
+        __m512i c = _mm512_loadu_si512((const void *)(rows[2] + k));
+        __m512i e = _mm512_loadu_si512((const void *)(rows[3] + k));
+        __m512i f = _mm512_loadu_si512((const void *)(rows[4] + k));
+        __m512i sum = _mm512_add_epi16(_mm512_add_epi16(a, f),
+                                       _mm512_slli_epi16(_mm512_add_epi16(_mm512_add_epi16(b, e), _mm512_slli_epi16(c, 1)), 1));
+        sum = _mm512_srli_epi16(_mm512_mulhi_epu16(_mm512_add_epi16(sum, half), recip), 6);
+        // every value fits a byte, and the narrowing keeps the element order
+        _mm256_storeu_si256((__m256i *)(d + k), _mm512_cvtepi16_epi8(sum));
+    }
+    blurColFrom(k, rows, d, n);
+}
+
+// trunc((b - a + 1) / 2): the arithmetic shift rounds down, so negative values get one added first
+static void derivative(const uchar *a, const uchar *b, uchar *d, int n)
+{
+    const __m512i one = _mm512_set1_epi16(1);
+    int k = 0;
+    for (; k <= n - 32; k += 32)
+    {
+        __m512i v = _mm512_add_epi16(_mm512_sub_epi16(_mm512_cvtepu8_epi16(_mm256_loadu_si256((const __m256i *)(b + k))),
+                                                      _mm512_cvtepu8_epi16(_mm256_loadu_si256((const __m256i *)(a + k)))),
+                                     one);
+        v = _mm512_srai_epi16(_mm512_add_epi16(v, _mm512_srli_epi16(v, 15)), 1);
+        // the narrowing keeps the low byte, wrapping negative values like the cast to uchar
+        _mm256_storeu_si256((__m256i *)(d + k), _mm512_cvtepi16_epi8(v));
+    }
+    derivativeFrom(k, a, b, d, n);
+}
+
+static void smooth3(const uchar *a, const uchar *b, const uchar *c, short *d, int n)
+{
+    const __m512i two = _mm512_set1_epi16(2);
+    int k = 0;
+    for (; k <= n - 32; k += 32)
+    {
+        __m512i l = _mm512_cvtepu8_epi16(_mm256_loadu_si256((const __m256i *)(a + k)));
+        __m512i m = _mm512_cvtepu8_epi16(_mm256_loadu_si256((const __m256i *)(b + k)));
+        __m512i r = _mm512_cvtepu8_epi16(_mm256_loadu_si256((const __m256i *)(c + k)));
+        __m512i sum = _mm512_add_epi16(_mm512_add_epi16(l, r), _mm512_add_epi16(_mm512_slli_epi16(m, 1), two));
+        _mm512_storeu_si512((void *)(d + k), _mm512_srli_epi16(sum, 2));
+    }
+    smooth3From(k, a, b, c, d, n);
+}
+
+static void magnitudeRow(const short *x, const short *y, uchar *d, int n)
+{
+    int k = 0;
+    for (; k <= n - 16; k += 16)
+    {
+        __m512 fx = _mm512_cvtepi32_ps(_mm512_cvtepi16_epi32(_mm256_loadu_si256((const __m256i *)(x + k))));
+        __m512 fy = _mm512_cvtepi32_ps(_mm512_cvtepi16_epi32(_mm256_loadu_si256((const __m256i *)(y + k))));
+        __m512 sum = _mm512_add_ps(_mm512_mul_ps(fx, fx), _mm512_mul_ps(fy, fy));
+        __m512i m = _mm512_cvttps_epi32(_mm512_sqrt_ps(sum));
+        // unsigned saturation caps the result at 255
+        _mm_storeu_si128((__m128i *)(d + k), _mm512_cvtusepi32_epi8(m));
+    }
+    magnitudeFrom(k, x, y, d, n);
+}
+
+extern const ImageKernels avx512Kernels = {"avx512", blurRow, blurCol, derivative, smooth3, magnitudeRow};
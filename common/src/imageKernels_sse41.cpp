@@ -0,0 +1,107 @@
+/**
+ * author: Harshit Kumar and Khushi Neema
+ * date: Oct 17, 2026
+ * purpose: SSE4.1 image kernels, built with -msse4.1 and only run on CPUs that have it.
+ *
+ */
+
+#include <smmintrin.h>
+#include "imageKernelRows.h"
+
+static void blurRow(const uchar *s, ushort *t, int n, int cn)
+{
+    int k = 0;
+    for (; k <= n - 8; k += 8)
+    {
+        __m128i m2 = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)(s + k - 2 * cn)));
+        __m128i m1 = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)(s + k - cn)));
+        __m128i c0 = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)(s + k)));
+        __m128i p1 = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)(s + k + cn)));
+        __m128i p2 = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)(s + k + 2 * cn)));
+        __m128i sum = _mm_add_epi16(_mm_add_epi16(m2, p2),
+                                    _mm_slli_epi16(_mm_add_epi16(_mm_add_epi16(m1, p1), _mm_slli_epi16(c0, 1)), 1));
+        _mm_storeu_si128((__m128i *)(t + k), sum);
+    }
+    blurRowFrom(k, s, t, n, cn);
+}
+
+// The largest sum is 255 * 100 + 50, so (x * 41944) >> 22 is an exact x / 100 for every input.
+static void blurCol(const ushort *const *rows, uchar *d, int n)
+{
+    const __m128i half = _mm_set1_epi16(50);
+    const __m128i recip = _mm_set1_epi16((short)41944);
+    int k = 0;
+    for (; k <= n - 8; k += 8)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *)(rows[0] + k));
+        __m128i b = _mm_loadu_si128((const __m128i *)(rows[1] + k));
+        __m128i c = _mm_loadu_si128((const __m128i *)(rows[2] + k));
+        __m128i e = _mm_loadu_si128((const __m128i *)(rows[3] + k));
+        __m128i f = _mm_loadu_si128((const __m128i *)(rows[4] + k));
+        __m128i sum = _mm_add_epi16(_mm_add_epi16(a, f),
+                                    _mm_slli_epi16(_mm_add_epi16(_mm_add_epi16(b, e), _mm_slli_epi16(c, 1)), 1));
+        sum = _mm_srli_epi16(_mm_mulhi_epu16(_mm_add_epi16(sum, half), recip), 6);
+        _mm_storel_epi64((__m128i *)(d + k), _mm_packus_epi16(sum, sum));
+    }
+    blurColFrom(k, rows, d, n);
+}
+
+// trunc((b - a + 1) / 2): the arithmetic shift rounds down, so negative values get one added first
+static void derivative(const uchar *a, const uchar *b, uchar *d, int n)
+{
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i lowByte = _mm_set1_epi16(0xff);
+    int k = 0;
+    for (; k <= n - 8; k += 8)
+    {
+        __m128i v = _mm_add_epi16(_mm_sub_epi16(_mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)(b + k))),
+                                                _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)(a + k)))),
+                                  one);
+        v = _mm_srai_epi16(_mm_add_epi16(v, _mm_srli_epi16(v, 15)), 1);
+        // keep the low byte, wrapping negative values like the cast to uchar
+        v = _mm_and_si128(v, lowByte);
+        _mm_storel_epi64((__m128i *)(d + k), _mm_packus_epi16(v, v));
+    }
+    derivativeFrom(k, a, b, d, n);
+}
+
+static void smooth3(const uchar *a, const uchar *b, const uchar *c, short *d, int n)
+{
+    const __m128i two = _mm_set1_epi16(2);
+    int k = 0;
+    for (; k <= n - 8; k += 8)
+    {
+        __m128i l = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)(a + k)));
+        __m128i m = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)(b + k)));
+        __m128i r = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)(c + k)));
+        __m128i sum = _mm_add_epi16(_mm_add_epi16(l, r), _mm_add_epi16(_mm_slli_epi16(m, 1), two));
+        _mm_storeu_si128((__m128i *)(d + k), _mm_srli_epi16(sum, 2));
+    }
+    smooth3From(k, a, b, c, d, n);
+}
+
+// sqrt of four 16-bit x, y pairs in float, truncated to 32-bit integers
+static inline __m128i magnitude4(__m128i x, __m128i y)
+{
+    __m128 fx = _mm_cvtepi32_ps(_mm_cvtepi16_epi32(x));
+    __m128 fy = _mm_cvtepi32_ps(_mm_cvtepi16_epi32(y));
+    return _mm_cvttps_epi32(_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(fx, fx), _mm_mul_ps(fy, fy))));
+}
+
+static void magnitudeRow(const short *x, const short *y, uchar *d, int n)
+{
+    int k = 0;
+    for (; k <= n - 8; k += 8)
+    {
+        __m128i xs = _mm_loadu_si128((const __m128i *)(x + k));
+        __m128i ys = _mm_loadu_si128((const __m128i *)(y + k));
+        __m128i lo = magnitude4(xs, ys);
+        __m128i hi = magnitude4(_mm_srli_si128(xs, 8), _mm_srli_si128(ys, 8));
+        // both packs saturate, which caps the result at 255
+        __m128i m = _mm_packs_epi32(lo, hi);
+        _mm_storel_epi64((__m128i *)(d + k), _mm_packus_epi16(m, m));
+    }
+    magnitudeFrom(k, x, y, d, n);
+}
+
+extern const ImageKernels sse41Kernels = {"sse4.1", blurRow, blurCol, derivative, smooth3, magnitudeRow};
@@ -0,0 +1,515 @@
+/**
+ * author: Harshit Kumar and Khushi Neema
+ * date: Oct 17, 2026
+ * purpose: Benchmarks every filter in filter.h over synthetic and on-disk images.
+ *
+ * usage: project1_bench [options] [image files...]
+ *   --repeat N       timed calls per case (default 20)
+ *   --warmup N       untimed calls per case (default 2)
+ *   --budget S       stop repeating a case after S seconds (default 3)
+ *   --sizes LIST     comma separated synthetic sizes: vga,720p,1080p,4k,8k (default all)
+ *   --filter NAME    only run filters whose name contains NAME
+ *   --threads N      filter thread count (see setFilterThreads)
+ *   --tile-width N   column tile width in pixels, 0 for automatic (see setFilterTileWidth)
+ *   --label TEXT     free-form tag stored in the JSON (e.g. a commit hash)
+ *   --json FILE      write machine-readable results to FILE
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "filter.h"
+#include "allocCounter.h"
+
+typedef int (*BenchFn)(cv::Mat &src, cv::Mat &dst, FilterWorkspace &ws);
+
+// one benchmarked filter: how to call it, how many bytes it moves per pixel and, for
+// approximations, the exact filter whose output it is compared with
+struct BenchFilter
+{
+    const char *name;
+    int bytesInPerPixel;
+    int bytesOutPerPixel;
+    BenchFn run;
+    BenchFn reference; // NULL if the filter is exact
+};
+
+// one input image
+struct BenchImage
+{
+    std::string name;
+    cv::Mat image;
+};
+
+// timing result of one filter on one image
+struct BenchResult
+{
+    std::string filter;
+    std::string image;
+    int width;
+    int height;
+    int samples;
+    double minMs;
+    double medianMs;
+    double p99Ms;
+    double meanMs;
+    double mpixPerSec;
+    double bytesMoved;
+    double gbPerSec;
+    double allocsPerCall; // heap allocations per timed call, -1 unless built with PROJECT1_COUNT_ALLOCS
+    double psnr;          // dB against the reference filter, -1 if there is none
+};
+
+// adapters so every filter has the same (src, dst, workspace) shape; the workspace
+// and dst live across calls, as they do in the video pipeline
+static int runGreyscale(cv::Mat &src, cv::Mat &dst, FilterWorkspace &)
+{
+    dst.create(src.size(), src.type());
+    return greyscale(src, dst);
+}
+
+static int runSepia(cv::Mat &src, cv::Mat &dst, FilterWorkspace &)
+{
+    dst.create(src.size(), src.type());
+    return sepia(src, dst);
+}
+
+static int runWarm(cv::Mat &src, cv::Mat &dst, FilterWorkspace &)
+{
+    return colorMatrix(src, dst, warmMatrix);
+}
+
+static int runBlur1(cv::Mat &src, cv::Mat &dst, FilterWorkspace &ws)
+{
+    return blur5x5_1(src, dst, ws);
+}
+
+static int runBlur2(cv::Mat &src, cv::Mat &dst, FilterWorkspace &ws)
+{
+    return blur5x5_2(src, dst, ws);
+}
+
+static int runSobelX(cv::Mat &src, cv::Mat &dst, FilterWorkspace &ws)
+{
+    return sobelX3x3(src, dst, ws);
+}
+
+static int runSobelY(cv::Mat &src, cv::Mat &dst, FilterWorkspace &ws)
+{
+    return sobelY3x3(src, dst, ws);
+}
+
+static int runMagnitude(cv::Mat &src, cv::Mat &dst, FilterWorkspace &ws)
+{
+    // the Sobel inputs are computed on the first (warmup) call, so only magnitude() is timed
+    static cv::Mat sx, sy, prepared;
+    if (prepared.data != src.data || sx.size() != src.size())
+    {
+        sobelX3x3(src, sx, ws);
+        sobelY3x3(src, sy, ws);
+        prepared = src;
+    }
+    return magnitude(sx, sy, dst);
+}
+
+static int runSobelMagnitude(cv::Mat &src, cv::Mat &dst, FilterWorkspace &ws)
+{
+    return sobelMagnitude3x3(src, NULL, NULL, &dst, NULL, ws);
+}
+
+static int runSobelAll(cv::Mat &src, cv::Mat &dst, FilterWorkspace &ws)
+{
+    static cv::Mat gx, gy;
+    return sobelMagnitude3x3(src, &gx, &gy, &dst, NULL, ws);
+}
+
+static int runGaussian(cv::Mat &src, cv::Mat &dst, FilterWorkspace &ws)
+{
+    return gaussian7x7(src, dst, ws);
+}
+
+static int runBlurQuantize(cv::Mat &src, cv::Mat &dst, FilterWorkspace &ws)
+{
+    return blurQuantize(src, dst, 10, ws);
+}
+
+static int runBilateral(cv::Mat &src, cv::Mat &dst, FilterWorkspace &ws)
+{
+    return bilateralSmooth(src, dst, 0, ws);
+}
+
+static int runDomain1(cv::Mat &src, cv::Mat &dst, FilterWorkspace &ws)
+{
+    return bilateralSmooth(src, dst, 1, ws);
+}
+
+static int runDomain2(cv::Mat &src, cv::Mat &dst, FilterWorkspace &ws)
+{
+    return bilateralSmooth(src, dst, 2, ws);
+}
+
+static int runDomain3(cv::Mat &src, cv::Mat &dst, FilterWorkspace &ws)
+{
+    return bilateralSmooth(src, dst, 3, ws);
+}
+
+static int runComic(cv::Mat &src, cv::Mat &dst, FilterWorkspace &ws)
+{
+    return comicBookEffect(src, dst, comicDefaultQuality, ws);
+}
+
+static int runComicReference(cv::Mat &src, cv::Mat &dst, FilterWorkspace &ws)
+{
+    return comicBookEffect(src, dst, 0, ws);
+}
+
+// greyscale copy of the input, converted once per image outside the timed calls
+static cv::Mat &greyOf(cv::Mat &src)
+{
+    static cv::Mat grey, prepared;
+    if (prepared.data != src.data || grey.size() != src.size())
+    {
+        cv::cvtColor(src, grey, cv::COLOR_BGR2GRAY);
+        prepared = src;
+    }
+    return grey;
+}
+
+static int runBlur2Grey(cv::Mat &src, cv::Mat &dst, FilterWorkspace &ws)
+{
+    return blur5x5_2(greyOf(src), dst, ws);
+}
+
+static int runGaussianGrey(cv::Mat &src, cv::Mat &dst, FilterWorkspace &ws)
+{
+    return gaussian7x7(greyOf(src), dst, ws);
+}
+
+static int runSobelMagnitudeGrey(cv::Mat &src, cv::Mat &dst, FilterWorkspace &ws)
+{
+    return sobelMagnitude3x3(greyOf(src), NULL, NULL, &dst, NULL, ws);
+}
+
+// a face-sized box in the middle of the frame for the compositing functions
+static std::vector<cv::Rect> &centreBox(const cv::Mat &src)
+{
+    static std::vector<cv::Rect> boxes(1);
+    boxes[0] = cv::Rect(src.cols * 3 / 8, src.rows / 4, src.cols / 4, src.rows / 2);
+    return boxes;
+}
+
+static int runGreyOutside(cv::Mat &src, cv::Mat &dst, FilterWorkspace &ws)
+{
+    return greyOutside(src, dst, centreBox(src), ws);
+}
+
+static int runBlurOutside(cv::Mat &src, cv::Mat &dst, FilterWorkspace &ws)
+{
+    return blurOutside(src, dst, centreBox(src), 2, ws);
+}
+
+// the background model is kept across calls, so every call after the first times the update
+static int runMotion(cv::Mat &src, cv::Mat &dst, FilterWorkspace &)
+{
+    static MotionModel model;
+    return motionDetect(src, &dst, model);
+}
+
+static const BenchFilter filters[] = {
+    {"greyscale", 3, 3, runGreyscale, NULL},
+    {"sepia", 3, 3, runSepia, NULL},
+    {"colorMatrix_warm", 3, 3, runWarm, NULL},
+    {"blur5x5_1", 3, 3, runBlur1, NULL},
+    {"blur5x5_2", 3, 3, runBlur2, NULL},
+    {"gaussian7x7", 3, 3, runGaussian, NULL},
+    {"sobelX3x3", 3, 6, runSobelX, NULL},
+    {"sobelY3x3", 3, 6, runSobelY, NULL},
+    {"magnitude", 12, 3, runMagnitude, NULL},
+    {"sobelMagnitude3x3", 3, 3, runSobelMagnitude, NULL},
+    {"sobelMagnitude3x3_all", 3, 15, runSobelAll, NULL},
+    {"blurQuantize", 3, 3, runBlurQuantize, NULL},
+    {"bilateralFilter", 3, 3, runBilateral, NULL},
+    {"bilateralSmooth_q1", 3, 3, runDomain1, runBilateral},
+    {"bilateralSmooth_q2", 3, 3, runDomain2, runBilateral},
+    {"bilateralSmooth_q3", 3, 3, runDomain3, runBilateral},
+    {"comicBookEffect", 3, 1, runComic, NULL},
+    {"comicBookEffect_ref", 3, 1, runComicReference, NULL},
+    {"blur5x5_2_grey", 1, 1, runBlur2Grey, NULL},
+    {"gaussian7x7_grey", 1, 1, runGaussianGrey, NULL},
+    {"sobelMagnitude3x3_grey", 1, 1, runSobelMagnitudeGrey, NULL},
+    {"greyOutside", 3, 3, runGreyOutside, NULL},
+    {"blurOutside_2", 3, 3, runBlurOutside, NULL},
+    {"motionDetect", 3, 3, runMotion, NULL},
+};
+
+// deterministic test pattern: smooth gradients plus hash noise, so the
+// filters see both flat regions and edges, identical on every run
+static cv::Mat syntheticImage(int width, int height)
+{
+    cv::Mat img(height, width, CV_8UC3);
+    unsigned int state = 12345;
+    for (int i = 0; i < height; i++)
+    {
+        cv::Vec3b *rowptr = img.ptr<cv::Vec3b>(i);
+        for (int j = 0; j < width; j++)
+        {
+            state = state * 1664525u + 1013904223u;
+            int noise = (state >> 24) & 31;
+            rowptr[j][0] = static_cast<uchar>((j * 255 / width + noise) & 255);
+            rowptr[j][1] = static_cast<uchar>((i * 255 / height + noise) & 255);
+            rowptr[j][2] = static_cast<uchar>((((i / 32) + (j / 32)) & 1) * 200 + noise);
+        }
+    }
+    return img;
+}
+
+static double percentile(std::vector<double> sorted, double p)
+{
+    // nearest-rank percentile of an ascending vector
+    size_t rank = (size_t)std::ceil(p / 100.0 * sorted.size());
+    rank = std::max<size_t>(rank, 1);
+    return sorted[std::min(rank, sorted.size()) - 1];
+}
+
+static BenchResult benchOne(const BenchFilter &filter, const BenchImage &input, int warmup, int repeat, double budget)
+{
+    cv::Mat src = input.image;
+    cv::Mat dst;
+    FilterWorkspace ws;
+
+    for (int i = 0; i < warmup; i++)
+    {
+        filter.run(src, dst, ws);
+    }
+
+    std::vector<double> times;
+    times.reserve(repeat);
+    size_t allocsBefore = allocationCount();
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeat; i++)
+    {
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        filter.run(src, dst, ws);
+        std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+
+        // slow filters at 8K would take minutes, three samples are enough there
+        if (i >= 2 && std::chrono::duration<double>(t1 - begin).count() > budget)
+        {
+            break;
+        }
+    }
+    size_t allocs = allocationCount() - allocsBefore;
+    std::sort(times.begin(), times.end());
+
+    BenchResult r;
+    r.filter = filter.name;
+    r.image = input.name;
+    r.width = src.cols;
+    r.height = src.rows;
+    r.samples = (int)times.size();
+    r.minMs = times.front();
+    r.medianMs = percentile(times, 50);
+    r.p99Ms = percentile(times, 99);
+    double sum = 0;
+    for (size_t i = 0; i < times.size(); i++)
+    {
+        sum += times[i];
+    }
+    r.meanMs = sum / times.size();
+    double pixels = (double)src.cols * src.rows;
+    r.mpixPerSec = pixels / (r.medianMs * 1e-3) / 1e6;
+    r.bytesMoved = pixels * (filter.bytesInPerPixel + filter.bytesOutPerPixel);
+    r.gbPerSec = r.bytesMoved / (r.medianMs * 1e-3) / 1e9;
+    r.allocsPerCall = allocationCountEnabled() ? (double)allocs / times.size() : -1;
+
+    // how close an approximation comes to the filter it replaces, untimed
+    r.psnr = -1;
+    if (filter.reference)
+    {
+        cv::Mat exact;
+        filter.reference(src, exact, ws);
+        r.psnr = cv::PSNR(dst, exact);
+    }
+    return r;
+}
+
+// instruction set the project's own kernels were compiled for, the shared ones pick theirs at run time
+// quotes a string for JSON (file names may contain backslashes or quotes)
+static std::string jsonString(const std::string &text)
+{
+    std::string out = "\"";
+    for (size_t i = 0; i < text.size(); i++)
+    {
+        if (text[i] == '"' || text[i] == '\\')
+            out += '\\';
+        out += text[i];
+    }
+    return out + "\"";
+}
+
+static void writeJson(const char *path, const std::vector<BenchResult> &results, const std::string &label,
+                      int warmup, int repeat)
+{
+    FILE *fp = fopen(path, "w");
+    if (!fp)
+    {
+        printf("Unable to write %s\n", path);
+        return;
+    }
+
+    char date[32];
+    time_t now = time(NULL);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"label\": %s,\n", jsonString(label).c_str());
+    fprintf(fp, "  \"date\": \"%s\",\n", date);
+    fprintf(fp, "  \"simd\": \"%s\",\n", filterKernelsIsa());
+    fprintf(fp, "  \"kernels\": \"%s\",\n", imageKernels().isa);
+    fprintf(fp, "  \"threads\": %d,\n", getFilterThreads());
+    fprintf(fp, "  \"tile_width\": %d,\n", getFilterTileWidth());
+    fprintf(fp, "  \"warmup\": %d,\n", warmup);
+    fprintf(fp, "  \"repeat\": %d,\n", repeat);
+    fprintf(fp, "  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const BenchResult &r = results[i];
+        fprintf(fp, "    {\"filter\": \"%s\", \"image\": %s, \"width\": %d, \"height\": %d, \"samples\": %d, "
+                    "\"min_ms\": %.4f, \"median_ms\": %.4f, \"p99_ms\": %.4f, \"mean_ms\": %.4f, "
+                    "\"mpix_per_s\": %.2f, \"bytes_moved\": %.0f, \"gb_per_s\": %.3f, \"allocs_per_call\": %.2f, "
+                    "\"psnr_db\": %.2f}%s\n",
+                r.filter.c_str(), jsonString(r.image).c_str(), r.width, r.height, r.samples,
+                r.minMs, r.medianMs, r.p99Ms, r.meanMs, r.mpixPerSec, r.bytesMoved, r.gbPerSec, r.allocsPerCall, r.psnr,
+                i + 1 < results.size() ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+    fclose(fp);
+    printf("Results written to %s\n", path);
+}
+
+int main(int argc, char *argv[])
+{
+    int repeat = 20;
+    int warmup = 2;
+    double budget = 3.0;
+    std::string sizes = "vga,720p,1080p,4k,8k";
+    std::string only;
+    std::string label;
+    const char *jsonPath = NULL;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--repeat") && hasValue)
+            repeat = std::max(1, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--warmup") && hasValue)
+            warmup = std::max(0, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--budget") && hasValue)
+            budget = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--sizes") && hasValue)
+            sizes = argv[++i];
+        else if (!strcmp(argv[i], "--filter") && hasValue)
+            only = argv[++i];
+        else if (!strcmp(argv[i], "--threads") && hasValue)
+            setFilterThreads(atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--tile-width") && hasValue)
+            setFilterTileWidth(atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--label") && hasValue)
+            label = argv[++i];
+        else if (!strcmp(argv[i], "--json") && hasValue)
+            jsonPath = argv[++i];
+        else if (argv[i][0] == '-')
+        {
+            printf("Usage %s [--repeat N] [--warmup N] [--budget S] [--sizes vga,720p,1080p,4k,8k] "
+                   "[--filter NAME] [--threads N] [--tile-width N] [--label TEXT] [--json FILE] [images...]\n",
+                   argv[0]);
+            return -1;
+        }
+        else
+            files.push_back(argv[i]);
+    }
+
+    // synthetic inputs at the requested resolutions
+    struct
+    {
+        const char *name;
+        int width;
+        int height;
+    } presets[] = {{"vga", 640, 480}, {"720p", 1280, 720}, {"1080p", 1920, 1080}, {"4k", 3840, 2160}, {"8k", 7680, 4320}};
+
+    std::vector<BenchImage> images;
+    std::string list = "," + sizes + ",";
+    for (size_t i = 0; i < sizeof(presets) / sizeof(presets[0]); i++)
+    {
+        if (list.find(std::string(",") + presets[i].name + ",") != std::string::npos)
+        {
+            BenchImage b;
+            b.name = std::string("synthetic_") + presets[i].name;
+            b.image = syntheticImage(presets[i].width, presets[i].height);
+            images.push_back(b);
+        }
+    }
+
+    // on-disk inputs at their native resolution
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        BenchImage b;
+        b.name = files[i];
+        b.image = cv::imread(files[i], cv::IMREAD_COLOR);
+        if (b.image.empty())
+        {
+            printf("Unable to read image %s\n", files[i].c_str());
+            return -1;
+        }
+        images.push_back(b);
+    }
+
+    printf("simd: %s, image kernels: %s, threads: %d, tile width: %d, warmup: %d, repeat: %d\n", filterKernelsIsa(),
+           describeImageKernels().c_str(), getFilterThreads(), getFilterTileWidth(), warmup, repeat);
+    printf("%-22s %-24s %11s %9s %9s %9s %10s %8s %7s\n", "filter", "image", "size", "min ms", "med ms", "p99 ms", "MPix/s", "GB/s",
+           allocationCountEnabled() ? "allocs" : "");
+
+    std::vector<BenchResult> results;
+    for (size_t f = 0; f < sizeof(filters) / sizeof(filters[0]); f++)
+    {
+        if (!only.empty() && std::string(filters[f].name).find(only) == std::string::npos)
+        {
+            continue;
+        }
+        for (size_t i = 0; i < images.size(); i++)
+        {
+            BenchResult r = benchOne(filters[f], images[i], warmup, repeat, budget);
+            char size[32];
+            snprintf(size, sizeof(size), "%dx%d", r.width, r.height);
+            printf("%-22s %-24s %11s %9.3f %9.3f %9.3f %10.1f %8.2f", r.filter.c_str(), r.image.c_str(), size,
+                   r.minMs, r.medianMs, r.p99Ms, r.mpixPerSec, r.gbPerSec);
+            if (r.allocsPerCall >= 0)
+            {
+                printf(" %7.2f", r.allocsPerCall);
+            }
+            if (r.psnr >= 0)
+            {
+                printf("  %.2f dB vs reference", r.psnr);
+            }
+            printf("\n");
+            fflush(stdout);
+            results.push_back(r);
+        }
+    }
+
+    if (jsonPath)
+    {
+        writeJson(jsonPath, results, label, warmup, repeat);
+    }
+
+    return 0;
+}
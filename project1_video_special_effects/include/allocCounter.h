@@ -0,0 +1,34 @@
+/**
+ * author: Harshit Kumar and Khushi Neema
+ * date: Oct 17, 2026
+ * purpose: Debug counter of heap allocations, to check the zero-allocation frame path.
+ *
+ */
+
+#ifndef ALLOCCOUNTER_H
+#define ALLOCCOUNTER_H
+
+#include <cstddef>
+
+/*
+  Counting is compiled in only with PROJECT1_COUNT_ALLOCS (cmake -DPROJECT1_COUNT_ALLOCS=ON),
+  which replaces the global operator new. Every cv::Mat buffer is counted as well, OpenCV
+  news the bookkeeping record of each buffer it allocates.
+ */
+
+/**
+ * @brief Returns true if the program was built with allocation counting.
+ */
+bool allocationCountEnabled();
+
+/**
+ * @brief Returns the number of heap allocations made so far by all threads, 0 if counting is off.
+ */
+size_t allocationCount();
+
+/**
+ * @brief Returns the number of heap allocations made so far by the calling thread, 0 if counting is off.
+ */
+size_t threadAllocationCount();
+
+#endif // ALLOCCOUNTER_H
@@ -0,0 +1,35 @@
+/**
+ * author: Harshit Kumar and Khushi Neema
+ * date: Oct 17, 2026
+ * purpose: Headless processing of a whole video file through an effect chain.
+ *
+ */
+
+#ifndef BATCHVIDEO_H
+#define BATCHVIDEO_H
+
+#include <string>
+
+/**
+ * @brief Applies an effect chain to every frame of a video file and writes the result,
+ * as fast as the machine allows and without opening a window.
+ *
+ * One thread decodes, several workers each run their own FilterGraph on whole
+ * frames, and the calling thread encodes. Frames are written in their original
+ * order however the workers finish, and at most a few frames per worker are in
+ * flight so memory stays bounded. The filters themselves run single-threaded
+ * here, the parallelism is across frames. Face stages detect on every frame
+ * instead of tracking, so the output does not depend on timing. A chain with a
+ * motion stage depends on the order of the frames and runs on one worker. A throughput
+ * report and the per-stage timing summary are printed at the end.
+ *
+ * @param inputSpec Video file to read, or any other frame source (see FrameSourceOptions), read unpaced.
+ * @param effectChain Effect chain, e.g. "blur>quantize:8>emboss" (see FilterGraph).
+ * @param outputPath File to write, MJPG at the frame rate of the input.
+ * @param workers Number of frames processed at once, 0 for one per core.
+ * @return 0 if the operation is successful, -1 if the chain is invalid or the input or output could not be opened.
+ */
+int processVideoFile(const std::string &inputSpec, const std::string &effectChain, const std::string &outputPath,
+                     int workers = 0);
+
+#endif // BATCHVIDEO_H
@@ -0,0 +1,168 @@
+/**
+ * author: Harshit Kumar and Khushi Neema
+ * date: Oct 17, 2026
+ * purpose: Bounded lock-free queue used to hand frames between pipeline threads.
+ *
+ */
+
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @brief Fixed-capacity multi-producer / multi-consumer queue without locks.
+ *
+ * Every cell carries a sequence number that tells producers and consumers whether
+ * it is free or filled for their current position (D. Vyukov's bounded queue).
+ * Because popping is safe from any thread, a producer can make room itself,
+ * which gives the drop-oldest policy used by the video pipeline.
+ */
+template <typename T>
+class BoundedQueue
+{
+public:
+    /**
+     * @brief Creates a queue holding at least capacity items (rounded up to a power of two, minimum 2).
+     */
+    explicit BoundedQueue(size_t capacity)
+    {
+        size_t size = 2;
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+        mask = size - 1;
+        cells.reset(new Cell[size]);
+        for (size_t i = 0; i < size; i++)
+        {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        enqueuePos.store(0, std::memory_order_relaxed);
+        dequeuePos.store(0, std::memory_order_relaxed);
+        droppedCount.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Appends item unless the queue is full.
+     * @return true if the item was queued.
+     */
+    bool tryPush(const T &item)
+    {
+        Cell *cell;
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            cell = &cells[pos & mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0)
+            {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false; // full
+            }
+            else
+            {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = item;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Removes the oldest item into item unless the queue is empty.
+     * @return true if an item was removed.
+     */
+    bool tryPop(T &item)
+    {
+        Cell *cell;
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            cell = &cells[pos & mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+            if (diff == 0)
+            {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false; // empty
+            }
+            else
+            {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        item = cell->data;
+        // release what the cell held now rather than when the slot is reused
+        cell->data = T();
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Appends item, discarding the oldest queued items while the queue is full.
+     * @return Number of items discarded to make room.
+     */
+    size_t pushDropOldest(const T &item)
+    {
+        size_t dropped = 0;
+        while (!tryPush(item))
+        {
+            T oldest;
+            if (tryPop(oldest))
+            {
+                dropped++;
+            }
+        }
+        droppedCount.fetch_add(dropped, std::memory_order_relaxed);
+        return dropped;
+    }
+
+    /**
+     * @brief Total number of items discarded by pushDropOldest().
+     */
+    size_t dropped() const
+    {
+        return droppedCount.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+    // producers and consumers hammer different counters, pad them onto separate
+    // cache lines (padding rather than alignas, C++11 new ignores over-alignment)
+    char padBefore[64];
+    std::atomic<size_t> enqueuePos;
+    char padEnqueue[64 - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> dequeuePos;
+    char padDequeue[64 - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> droppedCount;
+
+    BoundedQueue(const BoundedQueue &);
+    BoundedQueue &operator=(const BoundedQueue &);
+};
+
+#endif // BOUNDEDQUEUE_H
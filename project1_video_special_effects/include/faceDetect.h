@@ -11,8 +11,17 @@
 // put the path to the haar cascade file here
 #define FACE_CASCADE_FILE "/Users/harshit/Documents/CS5330ComputerVision/project1_video_special_effects/faceDetect/haarcascade_frontalface_alt2.xml"
 
+// work done by one detection call, to compare full and incremental searches
+struct FaceDetectStats {
+  bool fullScan;          // true if the whole image was searched
+  int regions;            // number of regions searched
+  long pixelsScanned;     // pixels of every pyramid level searched (half-size image)
+  long windowPositions;   // window positions on them, estimated from the step, not counted by the cascade
+};
+
 // prototypes
 int detectFaces( cv::Mat &grey, std::vector<cv::Rect> &faces );
+int detectFacesNear( cv::Mat &grey, std::vector<cv::Rect> &faces, const std::vector<cv::Rect> &previous, FaceDetectStats *stats = NULL );
 int drawBoxes( cv::Mat &frame, std::vector<cv::Rect> &faces, int minWidth = 50, float scale = 1.0  );
 
 #endif
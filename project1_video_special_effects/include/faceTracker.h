@@ -0,0 +1,123 @@
+/**
+ * author: Harshit Kumar and Khushi Neema
+ * date: Oct 17, 2026
+ * purpose: Face boxes for every frame from a background detector plus optical-flow tracking.
+ *
+ */
+
+#ifndef FACETRACKER_H
+#define FACETRACKER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "frameStats.h"
+
+/**
+ * @brief Keeps face boxes up to date at frame rate without running the cascade on every frame.
+ *
+ * The Haar cascade (detectFaces) runs on a worker thread, always on the newest
+ * frame handed over while it was idle. Between detections every box is moved by
+ * the median optical flow of corner features inside it. A finished detection is
+ * first tracked from the frame it ran on to the current one, then replaces the
+ * boxes; a box that overlaps its previous position is averaged with it to damp
+ * jitter, and a box that the detector misses twice in a row is dropped.
+ *
+ * Most detections only search around the current boxes (detectFacesNear); the
+ * whole frame is searched when there are no boxes, when a search lost a face,
+ * and every fullScanInterval() detections to pick up new faces.
+ */
+class FaceTracker
+{
+public:
+    FaceTracker();
+
+    /**
+     * @brief Stops the detector thread.
+     */
+    ~FaceTracker();
+
+    /**
+     * @brief Moves the boxes to a new frame and hands the frame to the detector if it is idle.
+     * @param grey Greyscale frame, the same size as the previous ones (a new size resets the boxes).
+     * @param faces Set to the face boxes in grey.
+     */
+    void update(const cv::Mat &grey, std::vector<cv::Rect> &faces);
+
+    /**
+     * @brief Records the detector time ("faceDetect") and the tracking time ("faceTrack") in stats.
+     * @param stats Timing collector, NULL to stop recording.
+     */
+    void setStats(FrameStats *stats);
+
+    /**
+     * @brief Sets how often the whole frame is searched.
+     * @param detections Full scan every this many detections, 1 to always scan the whole frame.
+     */
+    void setFullScanInterval(int detections);
+
+    /**
+     * @brief Runs the full detector on every frame inside update() instead of on the
+     * worker thread, for offline processing where results must not depend on timing.
+     * Call before the first update().
+     */
+    void setDetectEveryFrame(bool on) { everyFrame = on; }
+
+    /** @brief Detections between two full scans. */
+    int fullScanInterval() const { return fullScanEvery; }
+
+    /** @brief Number of detections completed so far. */
+    size_t detections() const { return detected; }
+
+    /**
+     * @brief Prints how many full and incremental searches ran and the average
+     * pixels and cascade window positions each kind covered.
+     */
+    void printSummary();
+
+private:
+    struct Track
+    {
+        cv::Rect2f box;
+        int misses; // detections in a row that did not find this box
+    };
+
+    void detectLoop();
+    void track(const cv::Mat &from, const cv::Mat &to, std::vector<Track> &boxes);
+    void merge(const std::vector<cv::Rect> &found, const cv::Mat &foundOn, const cv::Mat &grey);
+
+    // shared with the detector thread
+    std::thread worker;
+    std::mutex lock;
+    std::condition_variable wake;
+    bool stopping;
+    bool busy;                    // the worker owns pending while set
+    bool hasResult;
+    cv::Mat pending;              // frame the detector runs on
+    std::vector<cv::Rect> seeds;  // boxes in pending, where an incremental search looks
+    std::vector<cv::Rect> result; // its faces
+    std::atomic<int> fullScanEvery;
+    size_t searches[2];           // incremental, full
+    double pixels[2];
+    double windowPositions[2];
+    std::atomic<FrameStats *> stats;
+    std::atomic<size_t> detected;
+
+    // caller thread state
+    bool everyFrame;
+    cv::Mat previous;
+    std::vector<Track> tracks;
+    std::vector<Track> aligned;
+    std::vector<cv::Point2f> points, moved;
+    std::vector<uchar> status;
+    std::vector<float> error;
+    std::vector<float> dx, dy;
+
+    FaceTracker(const FaceTracker &);
+    FaceTracker &operator=(const FaceTracker &);
+};
+
+#endif // FACETRACKER_H
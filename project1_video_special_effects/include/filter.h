@@ -8,66 +8,183 @@
 #ifndef FILTER_H
 #define FILTER_H
 
+#include <vector>
 #include <opencv2/opencv.hpp>
+#include "imageKernels.h"
+
+/** @brief Most pyramid levels blurOutside() takes. */
+const int maxBlurLevels = 4;
 
 /**
- * @brief Applies a custom greyscale filter to an image.
- * @param src Input image.
+ * @brief Caller-owned scratch memory for the filters: the row buffers of the
+ * shared kernels (KernelWorkspace, imageKernels.h) plus the tables and images
+ * kept by this file's effects. The thread count and column tile width are the
+ * library's settings, setFilterThreads() and setFilterTileWidth().
+ */
+class FilterWorkspace : public KernelWorkspace
+{
+public:
+    FilterWorkspace() : tableLevels(0) {}
+
+    /**
+     * @brief Returns the 256-entry table of quantize(), rebuilt only when levels
+     * differs from the previous call.
+     */
+    const uchar *quantizeTable(int levels);
+
+    /**
+     * @brief Image for level 1 to maxBlurLevels of the downsampled copies made by blurOutside(),
+     * level 0 for the smallest one stretched back to the full width.
+     */
+    cv::Mat &pyramid(int level) { return pyramidLevels[level]; }
+
+    /**
+     * @brief List of image regions, used by the compositing functions.
+     */
+    std::vector<cv::Rect> &regions() { return regionList; }
+
+private:
+    cv::Mat pyramidLevels[maxBlurLevels + 1];
+    std::vector<cv::Rect> regionList;
+    uchar table[256];
+    int tableLevels;
+};
+
+/**
+ * @brief Instruction set of the colour matrix, fused Sobel and motion kernels: the one
+ * imageKernels() picked, or the best one below it this build has (at most "avx2").
+ * @return "scalar", "sse4.1" or "avx2".
+ */
+const char *filterKernelsIsa();
+
+/**
+ * @brief A 3x3 colour matrix plus offset for BGR pixels. Row c gives output channel c
+ * (B, G, R) as m[c][0] * B + m[c][1] * G + m[c][2] * R + m[c][3].
+ *
+ * colorMatrix() runs it in 16-bit fixed point with 14 fraction bits, so the
+ * coefficients must lie in [-2, 2); results are rounded down and saturated to [0, 255].
+ */
+struct ColorMatrix
+{
+    float m[3][4];
+};
+
+// parameter sets for colorMatrix()
+extern const ColorMatrix sepiaMatrix;     // classic sepia tone
+extern const ColorMatrix greyscaleMatrix; // 255 - red in every channel
+extern const ColorMatrix warmMatrix;      // more red, less blue
+extern const ColorMatrix coolMatrix;      // more blue, less red
+extern const ColorMatrix swapRBMatrix;    // red and blue exchanged
+
+/**
+ * @brief Applies a colour matrix to every pixel of an image.
+ * @param src Input image (CV_8UC3).
+ * @param dst Output image, may be the same Mat as src.
+ * @param matrix Coefficients and offsets, e.g. sepiaMatrix.
+ * @return 0 if the operation is successful, -1 if src is not CV_8UC3.
+ */
+int colorMatrix(cv::Mat &src, cv::Mat &dst, const ColorMatrix &matrix);
+
+/**
+ * @brief Applies a custom greyscale filter to an image (colorMatrix() with greyscaleMatrix).
+ * @param src Input image (CV_8UC3).
  * @param dst Output image.
- * @return 0 if the operation is successful.
+ * @return 0 if the operation is successful, -1 if src is not CV_8UC3.
  *
  */
 int greyscale(cv::Mat &src, cv::Mat &dst);
 
 /**
- * @brief Applies a custom sepia filter to an image.
- * @param src Input image.
+ * @brief Applies a custom sepia filter to an image (colorMatrix() with sepiaMatrix).
+ * @param src Input image (CV_8UC3).
  * @param dst Output image.
- * @return 0 if the operation is successful.
+ * @return 0 if the operation is successful, -1 if src is not CV_8UC3.
  *
  */
 int sepia(cv::Mat &src, cv::Mat &dst);
 
 /**
  * @brief Applies a custom blur filter to an image.
- * @param src Input image.
+ * @param src Input image (CV_8UC1 or CV_8UC3).
  * @param dst Output image.
- * @return 0 if the operation is successful.
+ * @return 0 if the operation is successful, -1 if src is not CV_8UC1 or CV_8UC3.
  */
 int blur5x5_1(cv::Mat &src, cv::Mat &dst);
 
 /**
- * @brief Applies a custom blur filter to an image (faster version).
- * @param src Input image.
- * @param dst Output image.
- * @return 0 if the operation is successful.
+ * @brief blur5x5_1() with its scratch memory taken from ws.
+ */
+int blur5x5_1(cv::Mat &src, cv::Mat &dst, FilterWorkspace &ws);
+
+// blur5x5_2(), sobelX3x3() and sobelY3x3(), with or without a workspace, and magnitude()
+// are the shared versions in imageKernels.h.
+
+/**
+ * @brief Applies a 7x7 Gaussian blur ([1 6 15 20 15 6 1] in both directions) to an image,
+ * a stronger blur than blur5x5_2. The three-pixel border is black.
+ * @param src Input image (CV_8UC1 or CV_8UC3).
+ * @param dst Output image, may be the same Mat as src.
+ * @return 0 if the operation is successful, -1 if src is not CV_8UC1 or CV_8UC3.
  */
-int blur5x5_2(cv::Mat &src, cv::Mat &dst);
+int gaussian7x7(cv::Mat &src, cv::Mat &dst);
 
-/*
- * @brief Applies SobelX filter (horizontal edge detection) to an image
- * @param src Input image
- * @param dst Output image
- * @return 0 if the operation is succesful.
+/**
+ * @brief gaussian7x7() with its scratch memory taken from ws.
  */
-int sobelX3x3(cv::Mat &src, cv::Mat &dst);
+int gaussian7x7(cv::Mat &src, cv::Mat &dst, FilterWorkspace &ws);
 
-/*
- * @brief Applies SobelY filter (vertical edge detection) to an image
- * @param src Input image
- * @param dst Output image
- * @return 0 if the operation is succesful.
+/**
+ * @brief Fused 3x3 Sobel: computes the X and Y gradients, their magnitude and
+ * orientation in a single pass over the image, using rolling row buffers instead
+ * of full-frame temporaries. Pass NULL for any output that is not needed.
+ * The outputs have as many channels as src.
+ * @param src Input image (CV_8UC1 or CV_8UC3).
+ * @param gx Output X gradient (CV_16S), raw Sobel response in [-1020, 1020].
+ * @param gy Output Y gradient (CV_16S), raw Sobel response in [-1020, 1020].
+ * @param mag Output gradient magnitude (CV_8U), sqrt(gx^2 + gy^2) / 8 rounded.
+ * @param orientation Output gradient orientation (CV_32F), atan2(gy, gx) in radians.
+ * @return 0 if the operation is successful, -1 if src is not CV_8UC1 or CV_8UC3.
  */
-int sobelY3x3(cv::Mat &src, cv::Mat &dst);
+int sobelMagnitude3x3(cv::Mat &src, cv::Mat *gx, cv::Mat *gy, cv::Mat *mag, cv::Mat *orientation = NULL);
 
 /**
- * @brief generates a gradient magnitude to an image.
- * @param sobelX Input image.
- * @param sobelY Input image.
- * @param dst Output image.
- * @return 0 if the operation is successful.
+ * @brief sobelMagnitude3x3() with its scratch memory taken from ws.
+ */
+int sobelMagnitude3x3(cv::Mat &src, cv::Mat *gx, cv::Mat *gy, cv::Mat *mag, cv::Mat *orientation, FilterWorkspace &ws);
+
+/**
+ * @brief Edge-preserving smoothing with the recursive domain-transform filter
+ * (Gastal and Oliveira, 2011), a fast stand-in for cv::bilateralFilter.
+ *
+ * Every iteration runs a first-order recursive filter forwards and backwards along
+ * each row, then down and up each column. The share a pixel takes from its
+ * neighbour falls with their colour difference in guide, so the smoothing stops
+ * at edges. The cost grows with the number of pixels only, not with sigmaSpace.
+ * @param src Input image (CV_8UC1 or CV_8UC3).
+ * @param dst Output image, may be the same Mat as src.
+ * @param guide Image whose edges are kept (CV_8UC1 or CV_8UC3, the size of src), empty to use src.
+ * @param sigmaSpace Spatial standard deviation in pixels.
+ * @param sigmaColor Range standard deviation, in summed absolute channel differences of guide.
+ * @param iterations 1 (fastest) to 3 (fewest streaks along edges).
+ * @param ws Scratch memory.
+ * @return 0 if the operation is successful, -1 if a type, size or parameter is out of range.
  */
-int magnitude(cv::Mat &sobelX, cv::Mat &sobelY, cv::Mat &dst);
+int domainTransformFilter(cv::Mat &src, cv::Mat &dst, const cv::Mat &guide, float sigmaSpace, float sigmaColor,
+                          int iterations, FilterWorkspace &ws);
+
+/**
+ * @brief The smoothing step of comicBookEffect(): cv::bilateralFilter(src, dst, 9, 75, 75), or
+ * domainTransformFilter() with parameters matched to it.
+ * @param src Input image (CV_8UC1 or CV_8UC3).
+ * @param dst Output image, may be the same Mat as src.
+ * @param quality 0 for cv::bilateralFilter, 1 to 3 for the domain transform with that many iterations.
+ * @param ws Scratch memory.
+ * @return 0 if the operation is successful, -1 if the type or quality is out of range.
+ */
+int bilateralSmooth(cv::Mat &src, cv::Mat &dst, int quality, FilterWorkspace &ws);
+
+/** @brief Quality of comicBookEffect() when none is given. */
+const int comicDefaultQuality = 2;
 
 /**
  * @brief Applies a custom comic book effect to an image.
@@ -78,11 +195,131 @@ int magnitude(cv::Mat &sobelX, cv::Mat &sobelY, cv::Mat &dst);
 int comicBookEffect(cv::Mat &src, cv::Mat &dst);
 
 /**
- * @brief Blurs and quantizes an image.
- * @param src Input image.
+ * @brief comicBookEffect() with a choice of smoothing backend and its scratch memory taken from ws.
+ * @param src Input image (CV_8UC3, or CV_8UC1 for a greyscale frame).
+ * @param dst Output image (CV_8UC1).
+ * @param quality 0 smooths with cv::bilateralFilter (the reference, slow), 1 to 3 with the domain
+ * transform (see bilateralSmooth()), higher is closer to the reference and slower.
+ * @param ws Scratch memory.
+ * @return 0 if the operation is successful, -1 if src is not CV_8UC1 or CV_8UC3 or quality is out of range.
+ */
+int comicBookEffect(cv::Mat &src, cv::Mat &dst, int quality, FilterWorkspace &ws);
+
+/**
+ * @brief Quantizes every channel of an image into a fixed number of levels.
+ * @param src Input image (8-bit, any number of channels).
+ * @param dst Output image, may be the same Mat as src.
+ * @param levels to determine number of levels.
+ * @return 0 if the operation is successful, -1 if src is not 8-bit or levels is not positive.
+ */
+int quantize(cv::Mat &src, cv::Mat &dst, int levels);
+
+/**
+ * @brief Blurs and quantizes an image in a single pass (blur5x5_2() then quantize()).
+ * @param src Input image (CV_8UC1 or CV_8UC3).
  * @param dst Output image.
  * @param levels to determine number of levels.
- * @return 0 if the operation is successful.
+ * @return 0 if the operation is successful, -1 if src is not CV_8UC1 or CV_8UC3 or levels is not positive.
  */
 int blurQuantize(cv::Mat &src, cv::Mat &dst, int levels);
+
+/**
+ * @brief blurQuantize() with its scratch memory taken from ws.
+ */
+int blurQuantize(cv::Mat &src, cv::Mat &dst, int levels, FilterWorkspace &ws);
+
+/**
+ * @brief Turns an image grey outside a set of boxes and keeps the boxes in colour. Only
+ * the pixels outside the boxes are converted (to the luma of cv::cvtColor(COLOR_BGR2GRAY)
+ * in all three channels); the boxes are copied, or left alone when dst is src.
+ * @param src Input image (CV_8UC3).
+ * @param dst Output image (CV_8UC3), may be the same Mat as src.
+ * @param keep Boxes kept in colour, the parts outside the image are ignored.
+ * @param ws Scratch memory.
+ * @return 0 if the operation is successful, -1 if src is not CV_8UC3.
+ */
+int greyOutside(cv::Mat &src, cv::Mat &dst, const std::vector<cv::Rect> &keep, FilterWorkspace &ws);
+
+/**
+ * @brief Blurs an image outside a set of boxes and keeps the boxes sharp.
+ *
+ * The image is reduced levels times with cv::pyrDown (5x5 Gaussian, then half
+ * the size), and the pixels outside the boxes are interpolated back up from the
+ * smallest level (bilinear, as cv::resize). Each level doubles the blur radius
+ * and quarters the work, so a strong blur costs less than a weak one. The boxes
+ * are copied, or left alone when dst is src.
+ * @param src Input image (CV_8UC3).
+ * @param dst Output image (CV_8UC3), may be the same Mat as src.
+ * @param keep Boxes kept sharp, the parts outside the image are ignored.
+ * @param levels Pyramid levels, 1 (radius of about 2 pixels) to maxBlurLevels (about 16).
+ * @param ws Scratch memory, also holds the pyramid.
+ * @return 0 if the operation is successful, -1 if src is not CV_8UC3 or levels is out of range.
+ */
+int blurOutside(cv::Mat &src, cv::Mat &dst, const std::vector<cv::Rect> &keep, int levels, FilterWorkspace &ws);
+
+/** @brief Side of the square tiles motionDetect() reports motion in, in pixels. */
+const int motionTileSize = 32;
+
+/** @brief Difference from the background (in 8-bit levels) above which a pixel counts as moving. */
+const int motionDefaultThreshold = 25;
+
+/** @brief Learning rate of the background: every frame moves it 1 / 2^shift of the way to the frame. */
+const int motionDefaultShift = 5;
+
+/**
+ * @brief The running background of a video and the motion found in its last frame,
+ * kept from one motionDetect() call to the next.
+ *
+ * The background is an exponential moving average of the frames in 8.8 fixed
+ * point. Its memory is allocated on the first frame and whenever the frame size
+ * or type changes, which also starts a new background.
+ */
+class MotionModel
+{
+public:
+    MotionModel() : frames(0) {}
+
+    /** @brief Forgets the background, the next frame starts a new one. */
+    void reset() { frames = 0; }
+
+    /** @brief 255 where the last frame moved, 0 elsewhere (CV_8UC1). */
+    const cv::Mat &mask() const { return motion; }
+
+    /**
+     * @brief The motionTileSize tiles of the last frame with motion in them, adjacent
+     * tiles of a tile row merged into one rectangle. Every tile on a new background's
+     * first frame.
+     */
+    const std::vector<cv::Rect> &changedTiles() const { return changed; }
+
+    /** @brief Frames in the background since it was started. */
+    size_t frameCount() const { return frames; }
+
+private:
+    friend int motionDetect(cv::Mat &src, cv::Mat *highlight, MotionModel &model, int threshold, int learnShift);
+
+    cv::Mat background;            // per row one plane of 8.8 fixed-point means per channel
+    cv::Mat motion;
+    std::vector<uchar> tileFlags;  // one per tile, row by row
+    std::vector<cv::Rect> changed;
+    size_t frames;
+};
+
+/**
+ * @brief Finds the pixels of a frame that differ from the running background,
+ * then adds the frame to the background. One pass over the frame updates the
+ * background, the motion mask, the tile list and the highlight together.
+ *
+ * A pixel moves when one of its channels differs from the background by more than
+ * threshold. The first frame of a background only starts it and has no motion.
+ * @param src Input frame (CV_8UC1 or CV_8UC3).
+ * @param highlight Output, NULL if not needed: src with the moving pixels tinted red
+ * (white on greyscale frames). May be src.
+ * @param model Background, mask and tiles, updated.
+ * @param threshold Difference in 8-bit levels (0 to 255) above which a pixel moves.
+ * @param learnShift 1 to 8, the background moves 1 / 2^learnShift of the way to each frame.
+ * @return 0 if the operation is successful, -1 if src is not CV_8UC1 or CV_8UC3 or a parameter is out of range.
+ */
+int motionDetect(cv::Mat &src, cv::Mat *highlight, MotionModel &model, int threshold = motionDefaultThreshold,
+                 int learnShift = motionDefaultShift);
 #endif // FILTER_H
@@ -0,0 +1,192 @@
+/**
+ * author: Harshit Kumar and Khushi Neema
+ * date: Oct 17, 2026
+ * purpose: Chains the filters into a reusable effect pipeline ("filter graph").
+ *
+ */
+
+#ifndef FILTERGRAPH_H
+#define FILTERGRAPH_H
+
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "filter.h"
+#include "frameStats.h"
+#include "faceTracker.h"
+
+// one kind of stage (name, label, kernel), defined in filterGraph.cpp
+struct FilterStage;
+
+/**
+ * @brief Scratch state shared by the stages of a graph, reused from frame to frame.
+ */
+struct FilterContext
+{
+    FrameStats *stats;
+    FilterWorkspace ws;      // row buffers of the filters
+    cv::Mat grey;            // detector input
+    cv::Mat gx, gy;          // signed Sobel responses
+    cv::Mat ax, ay;          // their 8-bit absolute values
+    FaceTracker tracker;     // face boxes for the face stages
+    std::vector<cv::Rect> faces;
+    MotionModel motion;      // running background of the motion stages
+    int faceEvery;           // the boxes are updated on every faceEvery-th frame
+    size_t faceFrames;       // frames seen by the face stages since the last quality change
+};
+
+/**
+ * @brief How far a graph may cut corners to keep up with the frame rate (see QualityController).
+ */
+struct GraphQuality
+{
+    GraphQuality() : scale(1), cheapStages(false), faceEvery(1) {}
+
+    int scale;        // the chain runs on frames shrunk by this factor (1, 2 or 4) and scaled back up
+    bool cheapStages; // stages with a cheaper stand-in (e.g. blurslow -> blur) use it
+    int faceEvery;    // face boxes are updated on every faceEvery-th frame and reused in between
+
+    bool operator==(const GraphQuality &o) const
+    {
+        return scale == o.scale && cheapStages == o.cheapStages && faceEvery == o.faceEvery;
+    }
+
+    /** @brief A short description, e.g. "1/2 resolution, cheaper stages" or "full quality". */
+    std::string describe() const;
+};
+
+/**
+ * @brief A linear chain of named effect stages, e.g. "blur>quantize:8>emboss".
+ *
+ * configure() parses the chain and plans it once: adjacent stages that have a
+ * fused kernel are merged (blur followed by quantize runs as blurQuantize) and
+ * every stage gets its own output buffer. The buffers are sized on the first
+ * frame and then reused, so applying the same chain to frames of the same size
+ * does not allocate intermediate images.
+ *
+ * Stages are separated by '>' or ',' and take an optional integer parameter
+ * after a ':' (e.g. the number of levels for quantize). stageNames() lists
+ * the stages that exist.
+ *
+ * Stages that filter each channel on their own (blur, Sobel, quantize, ...)
+ * take greyscale frames as they are, so they can follow a greyscale stage.
+ * With setPlanar() a run of two or more of them on a colour frame is applied
+ * to the three planes one at a time, split before the run and merged after it.
+ *
+ * The motion stages keep a running background from frame to frame (one per
+ * graph, so a chain should hold one of them). After "motiongate" the stages that
+ * only look at a small neighbourhood of each pixel (everything but the face,
+ * comic and motion stages) run on the tiles that moved, each grown by a few
+ * pixels, and keep their previous output everywhere else; every
+ * gateRefreshFrames-th frame is processed whole.
+ */
+class FilterGraph
+{
+public:
+    FilterGraph();
+
+    /**
+     * @brief Replaces the chain with the one described by spec.
+     * @param spec Stage list, an empty string (or "original") passes frames through.
+     * @param error Set to a message naming the offending stage when spec is invalid.
+     * @return 0 if the chain was accepted, -1 otherwise (the previous chain is kept).
+     */
+    int configure(const std::string &spec, std::string *error = NULL);
+
+    /**
+     * @brief Applies the chain to frame, replacing it with the result.
+     * Frames must be CV_8UC3 or CV_8UC1 (greyscale stages may return CV_8UC1).
+     * @param frame Frame to process, owned by the caller; never aliased by the graph.
+     * @return 0 if the operation is successful, -1 if a stage failed.
+     */
+    int apply(cv::Mat &frame);
+
+    /**
+     * @brief Records the time of every stage (and face detection) in stats.
+     * @param stats Timing collector, NULL to stop recording.
+     */
+    void setStats(FrameStats *stats);
+
+    /** @brief The spec the graph was configured with. */
+    const std::string &spec() const { return specText; }
+
+    /** @brief Text drawn on the frame for this chain, e.g. "Custom Blur + Embossing Effect". */
+    std::string label() const;
+
+    /** @brief Colour of the label, the one of the first stage. */
+    cv::Scalar labelColor() const;
+
+    /** @brief The planned chain after fusion, e.g. "blurQuantize(8) > emboss". */
+    std::string plan() const;
+
+    /**
+     * @brief Sets the quality the chain runs at, full quality (the default) is GraphQuality().
+     * Kept when the chain is reconfigured.
+     */
+    void setQuality(const GraphQuality &quality);
+
+    /** @brief The quality set by setQuality(). */
+    const GraphQuality &quality() const { return current; }
+
+    /**
+     * @brief Runs chains of per-channel stages plane by plane instead of on interleaved
+     * BGR pixels. Same results, off by default: the kernels already vectorize the
+     * interleaved rows, so it only pays off on machines where the split and merge are
+     * cheaper than the strided loads. Also set by PROJECT1_PLANAR=1.
+     */
+    void setPlanar(bool on);
+
+    /** @brief Whether setPlanar() is on. */
+    bool planar() const { return planarRuns; }
+
+    /** @brief Whether some stage of the chain has a cheaper stand-in. */
+    bool hasCheaperStages() const;
+
+    /** @brief Whether some stage of the chain looks for faces. */
+    bool usesFaces() const;
+
+    /** @brief The tracker behind the face stages, for its settings and summary. */
+    FaceTracker &faceTracker() { return ctx.tracker; }
+
+    /** @brief Whether the output of a frame depends on the frames before it (a motion stage). */
+    bool isTemporal() const;
+
+    /** @brief Names of all stages accepted by configure(), separated by spaces. */
+    static std::string stageNames();
+
+    /** @brief Frames between two whole frames behind a motion gate. */
+    static const int gateRefreshFrames = 30;
+
+private:
+    struct Node
+    {
+        const FilterStage *stage;
+        int param;
+        const FilterStage *cheapStage; // stand-in at reduced quality, NULL if there is none
+        int cheapParam;
+        int planarRun;    // stages from this one on that run plane by plane, 0 if none
+        bool gated;        // behind a motion gate, runs on the moving tiles
+        cv::Mat in;        // greyscale input converted back to BGR, for stages that need colour
+        cv::Mat out;       // reused output buffer
+        cv::Mat planes[3]; // output planes inside a planar run
+        cv::Mat tile;      // output of one grown tile when gated, the size of out
+    };
+
+    void planBuffers(const cv::Mat &frame);
+    int applyChain(cv::Mat &frame);
+    int runNode(Node &n, cv::Mat *src, cv::Mat *dst, int count);
+    int runTiles(Node &n, cv::Mat &src, const std::vector<cv::Rect> &tiles);
+
+    std::string specText;
+    std::vector<Node> nodes;
+    cv::Size plannedSize;
+    int plannedType;
+    GraphQuality current;
+    bool planarRuns;
+    cv::Mat split[3];   // input planes of a planar run
+    size_t gatedFrames; // frames through the motion gate since the buffers were planned
+    cv::Mat small;      // the frame shrunk by current.scale
+    FilterContext ctx;
+};
+
+#endif // FILTERGRAPH_H
@@ -0,0 +1,156 @@
+/**
+ * author: Harshit Kumar and Khushi Neema
+ * date: Oct 17, 2026
+ * purpose: Processed frames published to other processes through a POSIX shared-memory ring.
+ *
+ */
+
+#ifndef FRAMERING_H
+#define FRAMERING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <opencv2/opencv.hpp>
+
+/** @brief Frames a ring holds unless told otherwise. */
+const int frameRingDefaultSlots = 8;
+
+/**
+ * @brief What a reader learns about a published frame besides its pixels.
+ */
+struct FrameRingInfo
+{
+    uint64_t sequence; // 1 for the first frame published, then one more per frame
+    double timestamp;  // capture time in seconds on the steady clock (CLOCK_MONOTONIC)
+};
+
+/**
+ * @brief Publishes frames into a named shared-memory ring that any number of
+ * local processes can map and read without copying (see FrameRingReader).
+ *
+ * The segment starts with a header (magic "FRNG", version, slot count, slot
+ * size, newest sequence number, closed flag) followed by the slots, each a
+ * small header (sequence, rows, cols, OpenCV type, row step, timestamp) and
+ * the pixels. Every slot is guarded by its sequence number like a seqlock:
+ * it is odd while the writer fills the slot and 2 * sequence once the frame
+ * is complete.
+ *
+ * The writer never waits for readers. Frame n goes to slot (n - 1) % slots,
+ * overwriting the oldest frame, so a slow reader skips frames rather than
+ * holding up the pipeline, and can tell afterwards whether a frame it was
+ * looking at was overwritten meanwhile.
+ */
+class FrameRingWriter
+{
+public:
+    FrameRingWriter();
+
+    /**
+     * @brief Unmaps the ring and removes its name, readers keep their mapping.
+     */
+    ~FrameRingWriter();
+
+    /**
+     * @brief Creates (or replaces) the shared-memory segment.
+     * @param name Segment name, e.g. "/project1", at most 30 characters on macOS.
+     * @param slotBytes Largest frame in bytes, rows * cols * elemSize().
+     * @param slots Number of frames the ring holds.
+     * @param error If not NULL, set to the reason when the segment cannot be created.
+     * @return 0 if the operation is successful, -1 if the segment cannot be created or mapped.
+     */
+    int open(const std::string &name, size_t slotBytes, int slots = frameRingDefaultSlots,
+             std::string *error = NULL);
+
+    /**
+     * @brief Copies a frame into the next slot and makes it visible to readers.
+     * @param frame 8-bit frame of any channel count, at most slotBytes large.
+     * @param timestamp Capture time in seconds on the steady clock.
+     * @return 0 if the operation is successful, -1 if the ring is not open or the frame does not fit.
+     */
+    int publish(const cv::Mat &frame, double timestamp);
+
+    /**
+     * @brief Marks the ring closed for the readers, unmaps and unlinks it.
+     */
+    void close();
+
+    /** @brief Whether open() succeeded and close() has not been called. */
+    bool isOpen() const { return base != NULL; }
+
+    /** @brief Frames published so far. */
+    uint64_t published() const { return sequence; }
+
+    /** @brief Frames that were too large for a slot and were left out. */
+    size_t skipped() const { return tooLarge; }
+
+private:
+    std::string name;
+    unsigned char *base;
+    size_t mapped;
+    uint64_t sequence;
+    size_t tooLarge;
+
+    FrameRingWriter(const FrameRingWriter &);
+    FrameRingWriter &operator=(const FrameRingWriter &);
+};
+
+/**
+ * @brief Maps a ring created by a FrameRingWriter and reads its frames in place.
+ *
+ * view() wraps a slot in a cv::Mat without copying. The writer may overwrite
+ * the slot at any time, so a reader checks isCurrent() after it has used the
+ * pixels and drops its result if the frame was overwritten meanwhile.
+ */
+class FrameRingReader
+{
+public:
+    FrameRingReader();
+
+    /** @brief Unmaps the ring. */
+    ~FrameRingReader();
+
+    /**
+     * @brief Maps an existing ring read-only.
+     * @param name Segment name given to FrameRingWriter::open().
+     * @param error If not NULL, set to the reason when the ring cannot be mapped.
+     * @return 0 if the operation is successful, -1 if there is no such ring or it is not a frame ring.
+     */
+    int open(const std::string &name, std::string *error = NULL);
+
+    /** @brief Sequence number of the newest complete frame, 0 before the first. */
+    uint64_t latest() const;
+
+    /** @brief Whether the writer has closed the ring. */
+    bool isClosed() const;
+
+    /** @brief Number of slots, the oldest frame still readable is latest() - slots() + 1. */
+    int slots() const { return slotCount; }
+
+    /**
+     * @brief Points frame at frame number sequence inside the ring, without copying.
+     * @param sequence Frame to read, see latest().
+     * @param frame Set to a read-only view of the pixels, valid while isCurrent(sequence).
+     * @param info Set to the frame's sequence number and timestamp.
+     * @return 0 if the operation is successful, -1 if the frame is not published yet, was overwritten or is being written.
+     */
+    int view(uint64_t sequence, cv::Mat &frame, FrameRingInfo &info) const;
+
+    /**
+     * @brief Whether frame number sequence is still in its slot, unchanged since view().
+     */
+    bool isCurrent(uint64_t sequence) const;
+
+private:
+    void unmap();
+
+    const unsigned char *base;
+    size_t mapped;
+    int slotCount;
+    size_t slotStride;
+
+    FrameRingReader(const FrameRingReader &);
+    FrameRingReader &operator=(const FrameRingReader &);
+};
+
+#endif // FRAMERING_H
@@ -0,0 +1,107 @@
+/**
+ * author: Harshit Kumar and Khushi Neema
+ * date: Oct 17, 2026
+ * purpose: Per-stage frame timing for the live viewer: rolling percentiles,
+ * an on-screen overlay and a summary on exit.
+ *
+ */
+
+#ifndef FRAMESTATS_H
+#define FRAMESTATS_H
+
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+/**
+ * @brief Collects how long each named pipeline stage takes, per frame.
+ *
+ * Every stage keeps a rolling window of recent samples (for the live p50/p95/p99)
+ * and a fixed-size histogram of the whole session (for the exit summary), so
+ * memory stays bounded however long the viewer runs. Safe to call from the
+ * capture, processing and display threads at once.
+ */
+class FrameStats
+{
+public:
+    /**
+     * @param window Number of recent samples per stage used for the live percentiles.
+     * @param budgetMs Frame budget, stages whose p95 exceeds it are highlighted.
+     */
+    explicit FrameStats(size_t window = 120, double budgetMs = 1000.0 / 30.0);
+
+    /**
+     * @brief Adds one sample for a stage, creating the stage on first use.
+     * @param stage Stage name, e.g. "capture".
+     * @param ms Duration in milliseconds.
+     */
+    void record(const std::string &stage, double ms);
+
+    /**
+     * @brief Counts a displayed frame for the fps estimate.
+     * @param timestamp Display time in seconds.
+     */
+    void frameShown(double timestamp);
+
+    /**
+     * @brief Draws the per-stage percentiles and fps in the top-right corner of frame.
+     */
+    void drawOverlay(cv::Mat &frame) const;
+
+    /**
+     * @brief Prints the whole-session percentiles of every stage to stdout.
+     */
+    void printSummary() const;
+
+private:
+    struct Stage
+    {
+        std::string name;
+        std::vector<double> recent; // ring buffer of the last window samples
+        size_t next;
+        std::vector<unsigned int> histogram;
+        size_t count;
+        double total;
+        double max;
+    };
+
+    Stage &stage(const std::string &name);
+    static void percentiles(std::vector<double> samples, double &p50, double &p95, double &p99);
+    static double histogramPercentile(const Stage &s, double p);
+    double fps() const;
+
+    size_t window;
+    double budgetMs;
+    std::vector<Stage> stages; // in order of first use
+    std::deque<double> shown;
+    mutable std::mutex lock;
+};
+
+/**
+ * @brief Times the enclosing scope and records it as one sample of a stage.
+ * A NULL stats pointer makes it a no-op.
+ */
+class StageTimer
+{
+public:
+    StageTimer(FrameStats *stats, const char *stage)
+        : stats(stats), stage(stage), start(std::chrono::steady_clock::now()) {}
+
+    ~StageTimer()
+    {
+        if (stats)
+        {
+            stats->record(stage, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+    }
+
+private:
+    FrameStats *stats;
+    const char *stage;
+    std::chrono::steady_clock::time_point start;
+};
+
+#endif // FRAMESTATS_H
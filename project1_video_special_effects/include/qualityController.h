@@ -0,0 +1,80 @@
+/**
+ * author: Harshit Kumar and Khushi Neema
+ * date: Oct 17, 2026
+ * purpose: Lowers the quality of the live effects when they miss the frame deadline, and restores it.
+ *
+ */
+
+#ifndef QUALITYCONTROLLER_H
+#define QUALITYCONTROLLER_H
+
+#include <string>
+#include <vector>
+#include "filterGraph.h"
+
+/**
+ * @brief Keeps a FilterGraph within a per-frame time budget by stepping it through
+ * a ladder of cheaper settings (GraphQuality).
+ *
+ * The ladder starts at full quality and adds, one step at a time, the cheaper
+ * stand-ins of the stages, face boxes updated only on every second frame, and
+ * processing at 1/2 and then 1/4 resolution. Steps that would not change the
+ * current chain (no stage with a stand-in, no face stage) are left out.
+ *
+ * After every frame the caller reports how long the graph took. When the mean of
+ * a short window of frames comes close to the budget the graph moves one step
+ * down. The first window after a step down also gives the saving of that step
+ * (its cost relative to the step above, measured on the same scene). The graph
+ * moves back up when the current cost divided by that saving fits the budget
+ * with some margin, so it does not flip back and forth on a steady scene. Every
+ * switch is printed.
+ */
+class QualityController
+{
+public:
+    /**
+     * @param budgetMs Time the graph may take per frame, 33.3 ms for 30 fps.
+     */
+    explicit QualityController(double budgetMs = 1000.0 / 30.0);
+
+    /**
+     * @brief Builds the ladder for the chain graph is configured with and puts the graph back
+     * at full quality. Call after every configure().
+     */
+    void reset(FilterGraph &graph);
+
+    /**
+     * @brief Records the time graph took for a frame and moves it up or down the ladder if needed.
+     * @param graph The graph that processed the frame.
+     * @param ms Time of apply() in milliseconds.
+     * @return true if the quality was changed.
+     */
+    bool frameDone(FilterGraph &graph, double ms);
+
+    /** @brief The frame budget in milliseconds. */
+    double budget() const { return budgetMs; }
+
+    /**
+     * @brief Prints the number of switches and how many frames ran at each quality.
+     */
+    void printSummary() const;
+
+private:
+    struct Step
+    {
+        GraphQuality quality;
+        double ratio; // cost at this step over cost at the step above, 0 until measured
+    };
+
+    void moveTo(FilterGraph &graph, size_t next, double mean);
+
+    double budgetMs;
+    std::vector<Step> ladder;
+    size_t level;
+    std::vector<double> window; // recent frame times at the current step
+    double leftAt;              // mean cost of the window that moved the graph down to this step, 0 if it moved up
+    size_t switches;
+    std::vector<std::pair<GraphQuality, size_t> > framesAt; // frames per quality, for the summary
+};
+
+#endif // QUALITYCONTROLLER_H
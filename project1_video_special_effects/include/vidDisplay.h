@@ -8,14 +8,41 @@
 #ifndef VIDDISPLAY_H
 #define VIDDISPLAY_H
 
+#include <string>
+#include <vector>
 #include <opencv2/opencv.hpp>
+#include "frameSource.h"
 
 /**
  * @brief Display video, allowing users to save frames and quit using keystrokes.
  * 
- * @param videoDeviceIndex Index of the video device (e.g., 0 for the default camera). 
- * @return 0 if the operation is successful.
+ * @param sourceOptions Where the frames come from (the default camera unless given) and their pacing.
+ * @param effectChain Effect chain shown at start, e.g. "blur>quantize>emboss" (see FilterGraph).
+ * @param publishName If not empty, every processed frame is also published to the shared-memory
+ * ring of this name (see FrameRingWriter), e.g. "/project1".
+ * @return 0 if the operation is successful, -1 if the source could not be opened.
  */
-int displayVideo(int videoDeviceIndex=0);
+int displayVideo(const FrameSourceOptions &sourceOptions=FrameSourceOptions(), const std::string &effectChain="",
+                 const std::string &publishName="");
+
+/**
+ * @brief Shows several sources at once, e.g. every USB camera of a host, each with
+ * its own capture thread and effect graph.
+ *
+ * The frames are processed by one shared pool of workers that take the sources
+ * in turn, a frame at a time, so a fast camera cannot starve a slow one and every
+ * graph sees its frames in order. The keys work as in displayVideo() and change
+ * the effect of all sources. Timing and latency are kept per source ('i' draws
+ * them on each view) and summarised per source on exit.
+ *
+ * @param sourceOptions The sources, at least one.
+ * @param effectChain Effect chain shown at start (see FilterGraph).
+ * @param mosaic Show the sources as tiles of one window and record that ("out.avi"),
+ * instead of one window and one file ("out_<n>.avi") per source.
+ * @param workers Number of frames processed at once, 0 for one per core (at most one per source).
+ * @return 0 if the operation is successful, -1 if a source could not be opened.
+ */
+int displayCameras(const std::vector<FrameSourceOptions> &sourceOptions, const std::string &effectChain="",
+                   bool mosaic=true, int workers=0);
 
 #endif // VIDDISPLAY_H
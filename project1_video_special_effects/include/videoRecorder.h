@@ -0,0 +1,128 @@
+/**
+ * author: Harshit Kumar and Khushi Neema
+ * date: Oct 17, 2026
+ * purpose: Records frames to a video file on a background encoder thread.
+ *
+ */
+
+#ifndef VIDEORECORDER_H
+#define VIDEORECORDER_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <opencv2/opencv.hpp>
+#include "boundedQueue.h"
+#include "frameStats.h"
+
+/**
+ * @brief Non-blocking video file sink.
+ *
+ * write() only queues the frame; encoding happens on a background thread. The
+ * container frame rate is measured from the capture timestamps of the first
+ * frames instead of being hard-coded, and frames are repeated where the input
+ * skipped time (dropped or slow frames) so the file plays back in real time.
+ */
+class VideoRecorder
+{
+public:
+    /**
+     * @brief Creates a recorder, the file is opened once the frame rate is known.
+     * @param path Output file path.
+     * @param fourcc Codec, e.g. cv::VideoWriter::fourcc('M', 'J', 'P', 'G').
+     * @param queueSize Number of frames that may wait for the encoder.
+     */
+    VideoRecorder(const std::string &path, int fourcc, size_t queueSize = 16);
+
+    /**
+     * @brief Stops the encoder thread after writing out every queued frame.
+     */
+    ~VideoRecorder();
+
+    /**
+     * @brief Queues a frame for encoding without blocking. The frame is dropped
+     * (and counted) if the encoder is too far behind. Once the file could not be
+     * opened the recorder stops and takes no more frames.
+     * @param frame Frame to record (BGR or greyscale), must not be modified afterwards.
+     * @param timestamp Capture time of the frame in seconds.
+     * @return true if the frame was queued.
+     */
+    bool write(const cv::Mat &frame, double timestamp);
+
+    /**
+     * @brief Marks a pause in recording, the next frame continues the file
+     * without filling the paused time.
+     */
+    void pause();
+
+    /**
+     * @brief Writes out the queued frames and closes the file.
+     */
+    void stop();
+
+    /**
+     * @brief Records the time of every encoded frame as a stage of stats.
+     * Call before the first write().
+     * @param stats Timing collector, NULL to stop recording.
+     * @param stage Stage name, must outlive the recorder.
+     */
+    void setStats(FrameStats *stats, const char *stage);
+
+    /** @brief Frames encoded into the file, including repeats. */
+    size_t framesWritten() const { return written; }
+
+    /** @brief Frames repeated to cover time the input skipped. */
+    size_t framesRepeated() const { return repeated; }
+
+    /** @brief Frames dropped because the encoder queue was full or the file could not be opened. */
+    size_t framesDropped() const { return dropped; }
+
+    /** @brief Frames left out because the input ran ahead of the file rate. */
+    size_t framesSkipped() const { return skipped; }
+
+    /** @brief Container frame rate, 0 until it has been measured. */
+    double fps() const { return measuredFps; }
+
+private:
+    struct TimedFrame
+    {
+        cv::Mat frame;
+        double timestamp;
+        bool resume;
+    };
+
+    void encodeLoop();
+    void encode(TimedFrame &item);
+    void openWriter();
+    void writeTimed(const TimedFrame &item);
+
+    std::string path;
+    int fourcc;
+    BoundedQueue<TimedFrame> queue;
+    std::thread encoder;
+    std::atomic<bool> stopping;
+    std::atomic<bool> paused;
+    std::atomic<FrameStats *> stats;
+    const char *statsStage;
+
+    // encoder thread state
+    cv::VideoWriter writer;
+    bool failed; // the file could not be opened
+    cv::Size frameSize;
+    std::vector<TimedFrame> warmup;
+    size_t warmupBegin; // first warmup frame after the last pause
+    cv::Mat lastFrame;
+    double timeOrigin;
+    size_t frameIndex;
+
+    std::atomic<size_t> written;
+    std::atomic<size_t> repeated;
+    std::atomic<size_t> dropped;
+    std::atomic<size_t> skipped;
+    std::atomic<double> measuredFps;
+
+    VideoRecorder(const VideoRecorder &);
+    VideoRecorder &operator=(const VideoRecorder &);
+};
+
+#endif // VIDEORECORDER_H
@@ -1,15 +1,80 @@
 #include <opencv2/core.hpp>
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/highgui.hpp>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <string>
+#include <vector>
+#include "include/filter.h"
 #include "include/imgDisplay.h"
 #include "include/vidDisplay.h"
+#include "include/batchVideo.h"
+#include "frameSource.h"
+#include "imageKernels.h"
 
 using namespace cv;
 
 int main(int argc, char** argv)
 {
     // displayImage("/Users/harshit/Documents/CS5330ComputerVision/test_app/starry_night.jpg");
-    displayVideo();
-    return 0;
+    std::cout << "Image kernels: " << describeImageKernels() << std::endl;
+    std::cout << "Filter kernels: " << filterKernelsIsa() << std::endl;
+
+    // the default camera unless --source picks a file, image directory or pattern;
+    // --source may be repeated to show several sources at once
+    std::vector<FrameSourceOptions> sources(1);
+    if (parseFrameSourceArgs(argc, argv, sources) != 0)
+    {
+        std::cout << "usage: " << argv[0] << " " << frameSourceUsage()
+                  << " [--publish <name>] [--separate] [effect chain]" << std::endl;
+        return 1;
+    }
+
+    // --publish /name also hands every processed frame to other processes (see project1_ringview),
+    // --separate shows several sources in their own windows instead of a mosaic
+    std::string publishName;
+    bool separate = false;
+    int kept = 1;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--publish") == 0 && i + 1 < argc)
+        {
+            publishName = argv[++i];
+        }
+        else if (strcmp(argv[i], "--separate") == 0)
+        {
+            separate = true;
+        }
+        else
+        {
+            argv[kept++] = argv[i];
+        }
+    }
+    argc = kept;
+
+    // headless: project1_app --batch input.mp4 "blur>quantize:8" output.avi [workers]
+    // the input may be any source, e.g. chessboard:1280x720:600
+    if (argc > 1 && std::string(argv[1]) == "--batch")
+    {
+        if (argc < 5)
+        {
+            std::cout << "usage: " << argv[0] << " --batch <input video or source> <effect chain> <output video> [workers]" << std::endl;
+            return 1;
+        }
+        return processVideoFile(argv[2], argv[3], argv[4], argc > 5 ? atoi(argv[5]) : 0) == 0 ? 0 : 1;
+    }
+
+    // optional effect chain to start with, e.g. project1_app "blur>quantize:8>emboss"
+    const std::string chain = argc > 1 ? argv[1] : "";
+    if (sources.size() > 1)
+    {
+        if (!publishName.empty())
+        {
+            std::cout << "--publish is only supported with a single source" << std::endl;
+            return 1;
+        }
+        return displayCameras(sources, chain, !separate) == 0 ? 0 : 1;
+    }
+    return displayVideo(sources[0], chain, publishName) == 0 ? 0 : 1;
 }
\ No newline at end of file
@@ -0,0 +1,132 @@
+/**
+ * author: Harshit Kumar and Khushi Neema
+ * date: Oct 17, 2026
+ * purpose: Reference consumer of the frame ring published by project1_app --publish.
+ *
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include "frameRing.h"
+
+// how often the counters are printed
+static const double reportSeconds = 1.0;
+
+// seconds on the clock the publisher stamps frames with
+static double secondsNow()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*
+  Follows the newest frames of a ring and reports how many it read, how many it
+  skipped because it fell behind and how many were overwritten while it read
+  them. Every frame is read in place: the mean brightness stands in for real
+  analytics, and --show displays the frames.
+
+  usage: project1_ringview <name> [--show] [--frames N]
+ */
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        printf("usage: %s <ring name, e.g. /project1> [--show] [--frames N]\n", argv[0]);
+        return 1;
+    }
+    const std::string name = argv[1];
+    bool show = false;
+    long limit = 0;
+    for (int i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--show") == 0)
+        {
+            show = true;
+        }
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+        {
+            limit = atol(argv[++i]);
+        }
+    }
+
+    // the publisher may not be up yet
+    FrameRingReader ring;
+    std::string error;
+    while (ring.open(name, &error) != 0)
+    {
+        printf("Waiting for %s (%s)\n", name.c_str(), error.c_str());
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+    printf("Reading %s, %d slots\n", name.c_str(), ring.slots());
+
+    // start at the newest frame, a consumer joining late does not replay the ring
+    uint64_t next = ring.latest() + 1;
+    size_t read = 0, skipped = 0, torn = 0, total = 0;
+    double latency = 0, brightness = 0;
+    double reportAt = secondsNow() + reportSeconds;
+    cv::Mat frame;
+    FrameRingInfo info;
+    while (limit == 0 || (long)total < limit)
+    {
+        const uint64_t latest = ring.latest();
+        if (latest < next)
+        {
+            if (ring.isClosed())
+            {
+                printf("%s was closed by the publisher\n", name.c_str());
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        else
+        {
+            // more than a ring behind (less one slot the writer may be filling): jump to the newest
+            if (latest - next + 2 > (uint64_t)ring.slots())
+            {
+                skipped += latest - next;
+                next = latest;
+            }
+            bool ok = ring.view(next, frame, info) == 0;
+            if (ok)
+            {
+                const cv::Scalar mean = cv::mean(frame);
+                const double seconds = secondsNow() - info.timestamp;
+                if (show)
+                {
+                    cv::imshow(name, frame);
+                    cv::waitKey(1);
+                }
+                // anything computed from the pixels only counts if the writer left them alone
+                ok = ring.isCurrent(next);
+                if (ok)
+                {
+                    brightness += (mean[0] + mean[1] + mean[2]) / frame.channels();
+                    latency += seconds;
+                    read++;
+                    total++;
+                }
+            }
+            if (!ok)
+            {
+                torn++;
+            }
+            next++;
+        }
+
+        const double now = secondsNow();
+        if (now >= reportAt)
+        {
+            printf("%zu frames (%.1f fps), %zu skipped, %zu overwritten while reading, latency %.1f ms, "
+                   "brightness %.1f\n",
+                   read, read / reportSeconds, skipped, torn, read ? latency / read * 1000.0 : 0.0,
+                   read ? brightness / read : 0.0);
+            read = skipped = torn = 0;
+            latency = brightness = 0;
+            reportAt = now + reportSeconds;
+        }
+    }
+    return 0;
+}
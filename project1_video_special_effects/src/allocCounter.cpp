@@ -0,0 +1,104 @@
+/**
+ * author: Harshit Kumar and Khushi Neema
+ * date: Oct 17, 2026
+ * purpose: Debug counter of heap allocations, to check the zero-allocation frame path.
+ *
+ */
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "allocCounter.h"
+
+#ifdef PROJECT1_COUNT_ALLOCS
+
+static std::atomic<size_t> totalAllocations(0);
+static thread_local size_t threadAllocations = 0;
+
+void *operator new(std::size_t size)
+{
+    totalAllocations.fetch_add(1, std::memory_order_relaxed);
+    threadAllocations++;
+    void *p = std::malloc(size ? size : 1);
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    try
+    {
+        return operator new(size);
+    }
+    catch (...)
+    {
+        return NULL;
+    }
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return operator new(size, std::nothrow);
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept
+{
+    std::free(p);
+}
+
+bool allocationCountEnabled()
+{
+    return true;
+}
+
+size_t allocationCount()
+{
+    return totalAllocations.load(std::memory_order_relaxed);
+}
+
+size_t threadAllocationCount()
+{
+    return threadAllocations;
+}
+
+#else
+
+bool allocationCountEnabled()
+{
+    return false;
+}
+
+size_t allocationCount()
+{
+    return 0;
+}
+
+size_t threadAllocationCount()
+{
+    return 0;
+}
+
+#endif // PROJECT1_COUNT_ALLOCS
@@ -0,0 +1,260 @@
+/**
+ * author: Harshit Kumar and Khushi Neema
+ * date: Oct 17, 2026
+ * purpose: Headless processing of a whole video file through an effect chain.
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "batchVideo.h"
+#include "filter.h"
+#include "filterGraph.h"
+#include "frameSource.h"
+#include "frameStats.h"
+
+// frames per worker that may be decoded but not yet encoded
+static const size_t framesPerWorker = 3;
+
+// A decoded frame and its position in the input
+struct BatchFrame
+{
+    size_t index;
+    cv::Mat frame;
+};
+
+// Frames moving from the decoder through the workers to the encoder
+struct BatchQueue
+{
+    std::mutex lock;
+    std::condition_variable changed;
+    std::deque<BatchFrame> todo;    // decoded, waiting for a worker
+    std::map<size_t, cv::Mat> done; // processed, waiting for their turn to be encoded
+    size_t decoded;                 // frames read so far
+    size_t inFlight;                // decoded but not yet encoded
+    size_t window;                  // most frames in flight
+    bool inputDone;
+    bool failed;
+};
+
+/*
+  Decoder: reads frames in order and hands them to the workers, waiting while
+  the encoder is a full window behind.
+ */
+static void decodeLoop(FrameSource &input, BatchQueue &queue, FrameStats &stats)
+{
+    for (;;)
+    {
+        BatchFrame item;
+        {
+            StageTimer timer(&stats, "decode");
+            input.read(item.frame);
+        }
+
+        std::unique_lock<std::mutex> guard(queue.lock);
+        queue.changed.wait(guard, [&queue] { return queue.inFlight < queue.window || queue.failed; });
+        if (item.frame.empty() || queue.failed)
+        {
+            queue.inputDone = true;
+            queue.changed.notify_all();
+            return;
+        }
+        item.index = queue.decoded++;
+        queue.inFlight++;
+        queue.todo.push_back(item);
+        queue.changed.notify_all();
+    }
+}
+
+/*
+  Worker: applies its own copy of the chain to whole frames until the input runs out.
+ */
+static void workerLoop(BatchQueue &queue, const std::string &effectChain, FrameStats &stats)
+{
+    FilterGraph graph;
+    graph.configure(effectChain);
+    graph.setStats(&stats);
+    // workers see frames out of order, so faces are found on every frame rather than tracked
+    graph.faceTracker().setDetectEveryFrame(true);
+
+    BatchFrame item;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> guard(queue.lock);
+            queue.changed.wait(guard, [&queue] { return !queue.todo.empty() || queue.inputDone; });
+            if (queue.todo.empty())
+            {
+                return;
+            }
+            item = queue.todo.front();
+            queue.todo.pop_front();
+        }
+
+        int status;
+        {
+            StageTimer timer(&stats, "effect");
+            status = graph.apply(item.frame);
+        }
+
+        std::lock_guard<std::mutex> guard(queue.lock);
+        if (status != 0)
+        {
+            queue.failed = true;
+        }
+        // handed on even after a failure, the encoder waits for every index in order
+        queue.done[item.index] = item.frame;
+        queue.changed.notify_all();
+    }
+}
+
+int processVideoFile(const std::string &inputSpec, const std::string &effectChain, const std::string &outputPath,
+                     int workers)
+{
+    // check the chain once here, every worker builds its own graph from it
+    FilterGraph check;
+    std::string error;
+    if (check.configure(effectChain, &error) != 0)
+    {
+        printf("Invalid effect chain: %s\n", error.c_str());
+        return -1;
+    }
+
+    // as fast as the frames can be read, whatever the source
+    std::unique_ptr<FrameSource> input;
+    if (openFrameSource(FrameSourceOptions(inputSpec, false), input, &error) != 0)
+    {
+        printf("Unable to open the input: %s\n", error.c_str());
+        return -1;
+    }
+    const double fps = input->fps();
+    const double frameCount = input->frameCount();
+
+    if (workers <= 0)
+    {
+        workers = std::max(1, (int)std::thread::hardware_concurrency());
+    }
+    if (check.isTemporal() && workers > 1)
+    {
+        printf("The chain keeps a background model, running it on one worker with the frames in order\n");
+        workers = 1;
+    }
+    printf("Processing %s with \"%s\" (%s) on %d workers\n", input->describe().c_str(), effectChain.c_str(),
+           check.plan().c_str(), workers);
+
+    // the cores are busy with whole frames, row bands would only oversubscribe them
+    const int filterThreads = getFilterThreads();
+    if (workers > 1)
+    {
+        setFilterThreads(1);
+    }
+
+    BatchQueue queue;
+    queue.decoded = 0;
+    queue.inFlight = 0;
+    queue.window = framesPerWorker * workers;
+    queue.inputDone = false;
+    queue.failed = false;
+
+    FrameStats stats;
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    std::thread decoder(decodeLoop, std::ref(*input), std::ref(queue), std::ref(stats));
+    std::vector<std::thread> pool;
+    for (int w = 0; w < workers; w++)
+    {
+        pool.push_back(std::thread(workerLoop, std::ref(queue), std::cref(effectChain), std::ref(stats)));
+    }
+
+    // encode on this thread, strictly in input order
+    cv::VideoWriter output;
+    const int fourcc = cv::VideoWriter::fourcc('M', 'J', 'P', 'G');
+    size_t next = 0;
+    double pixels = 0;
+    int status = 0;
+    for (;;)
+    {
+        cv::Mat frame;
+        {
+            std::unique_lock<std::mutex> guard(queue.lock);
+            queue.changed.wait(guard, [&queue, next] {
+                return queue.done.count(next) > 0 || (queue.inputDone && next == queue.decoded);
+            });
+            if (queue.done.count(next) == 0)
+            {
+                break;
+            }
+            frame = queue.done[next];
+            queue.done.erase(next);
+        }
+
+        // the size and colour of the output are only known from the first processed frame
+        if (!output.isOpened() && !output.open(outputPath, fourcc, fps, frame.size(), frame.channels() != 1))
+        {
+            printf("Unable to open %s for writing\n", outputPath.c_str());
+            status = -1;
+        }
+        else
+        {
+            StageTimer timer(&stats, "encode");
+            output.write(frame);
+        }
+        stats.frameShown(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        pixels += frame.total();
+        next++;
+
+        std::lock_guard<std::mutex> guard(queue.lock);
+        queue.inFlight--;
+        if (status != 0)
+        {
+            queue.failed = true;
+        }
+        queue.changed.notify_all();
+        if (queue.failed)
+        {
+            break;
+        }
+    }
+
+    // let the decoder and workers run out if the loop stopped early
+    {
+        std::lock_guard<std::mutex> guard(queue.lock);
+        if (next != queue.decoded || !queue.inputDone)
+        {
+            queue.failed = true;
+        }
+        queue.changed.notify_all();
+    }
+    decoder.join();
+    for (size_t w = 0; w < pool.size(); w++)
+    {
+        pool[w].join();
+    }
+    output.release();
+    setFilterThreads(filterThreads);
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("%s: %zu frames", outputPath.c_str(), next);
+    if (frameCount > 0)
+    {
+        printf(" of %.0f", frameCount);
+    }
+    printf(" in %.2f s, %.1f fps (%.1fx real time), %.1f MPixel/s\n", seconds, next / seconds,
+           next / seconds / fps, pixels / seconds / 1e6);
+    if (queue.failed)
+    {
+        printf("Stopped early: an effect stage or the encoder failed\n");
+        status = -1;
+    }
+    stats.printSummary();
+
+    return status;
+}
@@ -7,6 +7,7 @@
 
   The path to the Haar cascade file is define in faceDetect.h
 */
+#include <algorithm>
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
@@ -14,6 +15,33 @@
 #include "faceDetect.h"
 
 
+/*
+  Adds the work of one detectMultiScale call on an image of the given size to stats:
+  the pixels of every pyramid level it searches and the window positions on them,
+  estimated with the same scale and stride rules as the cascade classifier.
+ */
+static void countWork( cv::Size size, cv::Size window, double scaleFactor, cv::Size minSize, cv::Size maxSize, FaceDetectStats *stats ) {
+  if( maxSize.width <= 0 || maxSize.height <= 0 ) {
+    maxSize = size;
+  }
+
+  for( double factor = 1; ; factor *= scaleFactor ) {
+    cv::Size win( cvRound(window.width*factor), cvRound(window.height*factor) );
+    cv::Size scaled( cvRound(size.width/factor), cvRound(size.height/factor) );
+    if( scaled.width <= window.width || scaled.height <= window.height )
+      break;
+    if( win.width > maxSize.width || win.height > maxSize.height )
+      break;
+    if( win.width < minSize.width || win.height < minSize.height )
+      continue;
+
+    // the classifier steps two pixels at a time until the pyramid level is small
+    int step = factor > 2. ? 1 : 2;
+    stats->pixelsScanned += (long)scaled.width * scaled.height;
+    stats->windowPositions += (long)((scaled.width - window.width) / step + 1) * ((scaled.height - window.height) / step + 1);
+  }
+}
+
 /*
   Arguments:
   cv::Mat grey  - a greyscale source image in which to detect faces
@@ -21,6 +49,20 @@
      if the length of the vector is zero, no faces were found
  */
 int detectFaces( cv::Mat &grey, std::vector<cv::Rect> &faces ) {
+  std::vector<cv::Rect> previous;
+  return( detectFacesNear( grey, faces, previous ) );
+}
+
+/*
+  Arguments:
+  cv::Mat grey  - a greyscale source image in which to detect faces
+  std::vector<cv::Rect> &faces - a standard vector of cv::Rect rectangles indicating where faces were found
+  const std::vector<cv::Rect> &previous - faces found in a recent frame (full size coordinates);
+     only the area around each of them is searched, at scales close to its size.
+     If the vector is empty, the whole image is searched at every scale (the same as detectFaces).
+  FaceDetectStats *stats - if not NULL, set to the work done by this call
+ */
+int detectFacesNear( cv::Mat &grey, std::vector<cv::Rect> &faces, const std::vector<cv::Rect> &previous, FaceDetectStats *stats ) {
   // a static variable to hold a half-size image
   static cv::Mat half;
   
@@ -30,6 +72,13 @@ int detectFaces( cv::Mat &grey, std::vector<cv::Rect> &faces ) {
   // the path to the haar cascade file
   static cv::String face_cascade_file(FACE_CASCADE_FILE);
 
+  // faces found in one search region
+  static std::vector<cv::Rect> found;
+
+  // default settings of detectMultiScale
+  const double scaleFactor = 1.1;
+  const int minNeighbors = 3;
+
   if( face_cascade.empty() ) {
     if( !face_cascade.load( face_cascade_file ) ) {
       printf("Unable to load face cascade file\n");
@@ -38,6 +87,15 @@ int detectFaces( cv::Mat &grey, std::vector<cv::Rect> &faces ) {
     }
   }
 
+  FaceDetectStats local;
+  if( stats == NULL ) {
+    stats = &local;
+  }
+  stats->fullScan = previous.empty();
+  stats->regions = 0;
+  stats->pixelsScanned = 0;
+  stats->windowPositions = 0;
+
   // clear the vector of faces
   faces.clear();
   
@@ -47,8 +105,46 @@ int detectFaces( cv::Mat &grey, std::vector<cv::Rect> &faces ) {
   // equalize the image
   cv::equalizeHist( half, half );
 
-  // apply the Haar cascade detector
-  face_cascade.detectMultiScale( half, faces );
+  cv::Size window = face_cascade.getOriginalWindowSize();
+  if( previous.empty() ) {
+    // apply the Haar cascade detector
+    face_cascade.detectMultiScale( half, faces );
+    stats->regions = 1;
+    countWork( half.size(), window, scaleFactor, cv::Size(), cv::Size(), stats );
+  }
+  else {
+    cv::Rect image( 0, 0, half.cols, half.rows );
+    for(size_t i=0;i<previous.size();i++) {
+      // the previous face in the half-size image, grown by half its size on every side
+      cv::Rect face( previous[i].x/2, previous[i].y/2, previous[i].width/2, previous[i].height/2 );
+      int margin = std::max( face.width, face.height ) / 2;
+      cv::Rect region = cv::Rect( face.x - margin, face.y - margin, face.width + 2*margin, face.height + 2*margin ) & image;
+      if( region.width <= window.width || region.height <= window.height ) {
+        continue;
+      }
+
+      // only scales close to the previous size
+      cv::Size minSize( face.width*7/10, face.height*7/10 );
+      cv::Size maxSize( face.width*14/10, face.height*14/10 );
+      face_cascade.detectMultiScale( half(region), found, scaleFactor, minNeighbors, 0, minSize, maxSize );
+      stats->regions++;
+      countWork( region.size(), window, scaleFactor, minSize, maxSize, stats );
+
+      // back to image coordinates, regions of faces close together can find the same face twice
+      for(size_t j=0;j<found.size();j++) {
+        cv::Rect f( found[j].x + region.x, found[j].y + region.y, found[j].width, found[j].height );
+        bool duplicate = false;
+        for(size_t k=0;k<faces.size();k++) {
+          if( (f & faces[k]).area() * 2 > std::min( f.area(), faces[k].area() ) ) {
+            duplicate = true;
+          }
+        }
+        if( !duplicate ) {
+          faces.push_back( f );
+        }
+      }
+    }
+  }
 
   // adjust the rectangle sizes back to the full size image
   for(int i=0;i<faces.size();i++) {
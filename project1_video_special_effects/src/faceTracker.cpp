@@ -0,0 +1,282 @@
+/**
+ * author: Harshit Kumar and Khushi Neema
+ * date: Oct 17, 2026
+ * purpose: Face boxes for every frame from a background detector plus optical-flow tracking.
+ *
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include "faceTracker.h"
+#include "faceDetect.h"
+
+// detectFaces keeps its classifier and scratch image in statics, one caller at a time
+static std::mutex detectorLock;
+
+// features followed per box, and the fewest that still give a usable median
+static const int maxPoints = 24;
+static const size_t minPoints = 4;
+
+// a detection within this overlap of a box is the same face
+static const float sameFace = 0.3f;
+
+static float overlap(const cv::Rect2f &a, const cv::Rect2f &b)
+{
+    float inter = (a & b).area();
+    float uni = a.area() + b.area() - inter;
+    return uni > 0 ? inter / uni : 0;
+}
+
+static cv::Rect toRect(const cv::Rect2f &b)
+{
+    return cv::Rect(cvRound(b.x), cvRound(b.y), cvRound(b.width), cvRound(b.height));
+}
+
+static float median(std::vector<float> &values)
+{
+    std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+    return values[values.size() / 2];
+}
+
+FaceTracker::FaceTracker()
+    : stopping(false), busy(false), hasResult(false), fullScanEvery(10), stats(NULL), detected(0),
+      everyFrame(false)
+{
+    for (int k = 0; k < 2; k++)
+    {
+        searches[k] = 0;
+        pixels[k] = 0;
+        windowPositions[k] = 0;
+    }
+}
+
+FaceTracker::~FaceTracker()
+{
+    if (worker.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_one();
+        worker.join();
+    }
+}
+
+void FaceTracker::setStats(FrameStats *stats)
+{
+    this->stats = stats;
+}
+
+void FaceTracker::setFullScanInterval(int detections)
+{
+    fullScanEvery = std::max(detections, 1);
+}
+
+void FaceTracker::printSummary()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    const char *kinds[2] = {"incremental", "full"};
+    for (int k = 0; k < 2; k++)
+    {
+        if (searches[k] > 0)
+        {
+            printf("Face detection, %s searches: %zu, %.0f pixels and %.0f window positions each\n", kinds[k], searches[k],
+                   pixels[k] / searches[k], windowPositions[k] / searches[k]);
+        }
+    }
+}
+
+void FaceTracker::detectLoop()
+{
+    std::vector<cv::Rect> found;
+    std::vector<cv::Rect> near;
+    FaceDetectStats work;
+    int sinceFull = 0;
+    bool lost = false;
+    std::unique_lock<std::mutex> guard(lock);
+    for (;;)
+    {
+        wake.wait(guard, [this] { return stopping || busy; });
+        if (stopping)
+        {
+            return;
+        }
+
+        // search near the boxes unless it is time for a full scan
+        bool full = seeds.empty() || lost || sinceFull + 1 >= fullScanEvery;
+        near.clear();
+        if (!full)
+        {
+            near.swap(seeds);
+        }
+
+        // pending belongs to this thread until busy is cleared
+        guard.unlock();
+        {
+            StageTimer timer(stats, "faceDetect");
+            std::lock_guard<std::mutex> detector(detectorLock);
+            detectFacesNear(pending, found, near, &work);
+        }
+        guard.lock();
+
+        sinceFull = full ? 0 : sinceFull + 1;
+        // a face that was not found again may have moved out of its region
+        lost = !full && found.size() < near.size();
+        searches[full]++;
+        pixels[full] += work.pixelsScanned;
+        windowPositions[full] += work.windowPositions;
+
+        result.swap(found);
+        hasResult = true;
+        busy = false;
+        detected++;
+    }
+}
+
+void FaceTracker::track(const cv::Mat &from, const cv::Mat &to, std::vector<Track> &boxes)
+{
+    cv::Rect frame(0, 0, from.cols, from.rows);
+    for (size_t i = 0; i < boxes.size(); i++)
+    {
+        cv::Rect area = toRect(boxes[i].box) & frame;
+        if (area.width < 8 || area.height < 8)
+        {
+            continue;
+        }
+
+        // corners inside the box, followed into the next frame with pyramidal Lucas-Kanade
+        cv::goodFeaturesToTrack(from(area), points, maxPoints, 0.01, 3);
+        if (points.size() < minPoints)
+        {
+            continue;
+        }
+        for (size_t k = 0; k < points.size(); k++)
+        {
+            points[k].x += area.x;
+            points[k].y += area.y;
+        }
+        cv::calcOpticalFlowPyrLK(from, to, points, moved, status, error, cv::Size(15, 15), 2);
+
+        dx.clear();
+        dy.clear();
+        for (size_t k = 0; k < points.size(); k++)
+        {
+            if (status[k])
+            {
+                dx.push_back(moved[k].x - points[k].x);
+                dy.push_back(moved[k].y - points[k].y);
+            }
+        }
+        // too few features survived, leave the box where it is
+        if (dx.size() < minPoints)
+        {
+            continue;
+        }
+
+        // the median ignores the odd feature that jumped to the background
+        boxes[i].box.x += median(dx);
+        boxes[i].box.y += median(dy);
+    }
+}
+
+void FaceTracker::merge(const std::vector<cv::Rect> &found, const cv::Mat &foundOn, const cv::Mat &grey)
+{
+    // bring the detections from the (older) frame they ran on to the current one
+    aligned.clear();
+    for (size_t i = 0; i < found.size(); i++)
+    {
+        Track t;
+        t.box = cv::Rect2f((float)found[i].x, (float)found[i].y, (float)found[i].width, (float)found[i].height);
+        t.misses = 0;
+        aligned.push_back(t);
+    }
+    track(foundOn, grey, aligned);
+
+    // average each detection with the box it replaces, keep unmatched boxes for one more miss
+    for (size_t i = 0; i < tracks.size(); i++)
+    {
+        int best = -1;
+        float bestOverlap = sameFace;
+        for (size_t j = 0; j < aligned.size(); j++)
+        {
+            float o = overlap(tracks[i].box, aligned[j].box);
+            if (o > bestOverlap)
+            {
+                best = (int)j;
+                bestOverlap = o;
+            }
+        }
+        if (best >= 0)
+        {
+            cv::Rect2f &d = aligned[best].box;
+            const cv::Rect2f &t = tracks[i].box;
+            d = cv::Rect2f((d.x + t.x) / 2, (d.y + t.y) / 2, (d.width + t.width) / 2, (d.height + t.height) / 2);
+        }
+        else if (tracks[i].misses == 0)
+        {
+            // not found this time, dropped if the next detection misses it as well
+            Track kept = tracks[i];
+            kept.misses++;
+            aligned.push_back(kept);
+        }
+    }
+    tracks.swap(aligned);
+}
+
+void FaceTracker::update(const cv::Mat &grey, std::vector<cv::Rect> &faces)
+{
+    if (everyFrame)
+    {
+        // no worker in this mode, pending is only used as the detector's input here
+        StageTimer timer(stats, "faceDetect");
+        grey.copyTo(pending);
+        std::lock_guard<std::mutex> detector(detectorLock);
+        detectFaces(pending, faces);
+        detected++;
+        return;
+    }
+
+    if (!worker.joinable())
+    {
+        worker = std::thread(&FaceTracker::detectLoop, this);
+    }
+
+    {
+        StageTimer timer(stats, "faceTrack");
+        if (previous.size() == grey.size())
+        {
+            track(previous, grey, tracks);
+        }
+        else
+        {
+            tracks.clear();
+        }
+
+        std::lock_guard<std::mutex> guard(lock);
+        if (!busy)
+        {
+            // the worker is idle: take its result, then give it the newest frame
+            if (hasResult && pending.size() == grey.size())
+            {
+                merge(result, pending, grey);
+            }
+            hasResult = false;
+            grey.copyTo(pending);
+            seeds.clear();
+            for (size_t i = 0; i < tracks.size(); i++)
+            {
+                seeds.push_back(toRect(tracks[i].box));
+            }
+            busy = true;
+            wake.notify_one();
+        }
+    }
+    grey.copyTo(previous);
+
+    faces.clear();
+    for (size_t i = 0; i < tracks.size(); i++)
+    {
+        faces.push_back(toRect(tracks[i].box));
+    }
+}
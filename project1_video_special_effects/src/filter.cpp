@@ -5,64 +5,159 @@
  *
  */
 
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
 #include "filter.h"
+#include "filterKernels.h"
+#include "kernelBands.h"
 
-int greyscale(cv::Mat &src, cv::Mat &dst)
+// The neighbourhood filters take 8-bit images with one (greyscale) or three (BGR) channels.
+// Channels never mix, so a CV_8UC3 result equals the three planes filtered as CV_8UC1.
+static bool isFilterInput(const cv::Mat &m)
+{
+    return m.type() == CV_8UC1 || m.type() == CV_8UC3;
+}
+
+// Fills table with the level every 8-bit value quantizes to: (x / b) * b with b = 255 / levels
+static void buildQuantizeTable(uchar *table, int levels)
 {
-    // check src and dst Mat consistency
-    if (src.size() != dst.size())
+    const int b = std::max(255 / levels, 1);
+    for (int x = 0; x < 256; x++)
     {
-        return -1;
+        table[x] = static_cast<uchar>((x / b) * b);
+    }
+}
+
+const uchar *FilterWorkspace::quantizeTable(int levels)
+{
+    if (levels != tableLevels)
+    {
+        buildQuantizeTable(table, levels);
+        tableLevels = levels;
+    }
+    return table;
+}
+
+// Maps n bytes through a 256-entry table, s and d may be the same row
+static void lookupRow(const uchar *s, uchar *d, int n, const uchar *table)
+{
+    for (int k = 0; k < n; k++)
+    {
+        d[k] = table[s[k]];
     }
+}
+
+// out = m * (B, G, R) + offset, rows B, G, R
+const ColorMatrix sepiaMatrix = {{
+    {0.131f, 0.534f, 0.272f, 0},
+    {0.168f, 0.686f, 0.349f, 0},
+    {0.189f, 0.769f, 0.393f, 0},
+}};
+
+// 255 - red in every channel
+const ColorMatrix greyscaleMatrix = {{
+    {0, 0, -1, 255},
+    {0, 0, -1, 255},
+    {0, 0, -1, 255},
+}};
 
-    // apply custom greyscale transformation
-    for (int i = 0; i < src.rows; ++i)
+const ColorMatrix warmMatrix = {{
+    {0.8f, 0, 0, 0},
+    {0, 1, 0, 5},
+    {0, 0, 1.1f, 10},
+}};
+
+const ColorMatrix coolMatrix = {{
+    {1.1f, 0, 0, 10},
+    {0, 1, 0, 5},
+    {0, 0, 0.8f, 0},
+}};
+
+const ColorMatrix swapRBMatrix = {{
+    {0, 0, 1, 0},
+    {0, 1, 0, 0},
+    {1, 0, 0, 0},
+}};
+
+// Converts a matrix to fixed point, coefficients saturate at the 16-bit range
+static ColorCoeffs toFixedPoint(const ColorMatrix &matrix)
+{
+    ColorCoeffs c;
+    const float scale = (float)(1 << colorShift);
+    for (int ch = 0; ch < 3; ch++)
     {
-        for (int j = 0; j < src.cols; ++j)
+        for (int k = 0; k < 3; k++)
         {
-            // subtract the red channel value from 255
-            int greyValue = 255 - src.at<cv::Vec3b>(i, j)[2];
-            dst.at<cv::Vec3b>(i, j) = cv::Vec3b(greyValue, greyValue, greyValue);
+            c.m[ch][k] = std::min(std::max(cvRound(matrix.m[ch][k] * scale), -32768), 32767);
         }
+        c.offset[ch] = cvRound(matrix.m[ch][3] * scale);
     }
-
-    return 0;
+    return c;
 }
 
-int sepia(cv::Mat &src, cv::Mat &dst)
+int colorMatrix(cv::Mat &src, cv::Mat &dst, const ColorMatrix &matrix)
 {
-    // check src and dst Mat consistency
-    if (src.size() != dst.size())
+    if (src.type() != CV_8UC3)
     {
         return -1;
     }
 
-    // apply sepia transformation
-    for (int i = 0; i < src.rows; ++i)
+    // convert to fixed point once per call
+    const ColorCoeffs c = toFixedPoint(matrix);
+    const FilterKernels &kernels = filterKernels();
+
+    // pointwise, so dst may alias src
+    dst.create(src.size(), src.type());
+
+    forEachBand(src.rows, [&](int rowBegin, int rowEnd)
     {
-        for (int j = 0; j < src.cols; ++j)
+        for (int i = rowBegin; i < rowEnd; i++)
         {
-            // R .    G .    B .
-            // 0.272, 0.534, 0.131    // Blue coefficients
-            // 0.349, 0.686, 0.168    // Green coefficients
-            // 0.393, 0.769, 0.189     // Red coefficients
-            int blue = (src.at<cv::Vec3b>(i, j)[2] * 0.272) + (src.at<cv::Vec3b>(i, j)[1] * 0.534) + (src.at<cv::Vec3b>(i, j)[0] * 0.131);
-            int green = (src.at<cv::Vec3b>(i, j)[2] * 0.349) + (src.at<cv::Vec3b>(i, j)[1] * 0.686) + (src.at<cv::Vec3b>(i, j)[0] * 0.168);
-            int red = (src.at<cv::Vec3b>(i, j)[2] * 0.393) + (src.at<cv::Vec3b>(i, j)[1] * 0.769) + (src.at<cv::Vec3b>(i, j)[0] * 0.189);
-            // clip values to [0, 255]
-            blue = blue > 255 ? 255 : blue;
-            green = green > 255 ? 255 : green;
-            red = red > 255 ? 255 : red;
-            dst.at<cv::Vec3b>(i, j) = cv::Vec3b(blue, green, red);
+            kernels.colorMatrixRow(src.ptr<uchar>(i), dst.ptr<uchar>(i), src.cols, c);
         }
-    }
+    });
 
     return 0;
 }
 
+int greyscale(cv::Mat &src, cv::Mat &dst)
+{
+    return colorMatrix(src, dst, greyscaleMatrix);
+}
+
+int sepia(cv::Mat &src, cv::Mat &dst)
+{
+    return colorMatrix(src, dst, sepiaMatrix);
+}
+
 int blur5x5_1(cv::Mat &src, cv::Mat &dst)
 {
-    dst = src.clone();
+    FilterWorkspace ws;
+    return blur5x5_1(src, dst, ws);
+}
+
+int blur5x5_1(cv::Mat &src, cv::Mat &dst, FilterWorkspace &ws)
+{
+    if (!isFilterInput(src))
+    {
+        return -1;
+    }
+
+    // keep a handle on the input, dst may be the same Mat as src
+    cv::Mat input = src;
+    if (input.data == dst.data)
+    {
+        src.copyTo(ws.inputCopy());
+        input = ws.inputCopy();
+    }
+    else
+    {
+        // the two-pixel border keeps the input pixels
+        input.copyTo(dst);
+    }
 
     // Gaussian kernel
     int kernel[5][5] = {
@@ -73,94 +168,61 @@ int blur5x5_1(cv::Mat &src, cv::Mat &dst)
         {1, 2, 4, 2, 1}};
 
     // Loop through each pixel, excluding the first two and last two rows and columns
-    for (int i = 2; i < src.rows - 2; ++i)
+    const int cn = input.channels();
+    forEachBand(input.rows, [&](int rowBegin, int rowEnd)
     {
-        for (int j = 2; j < src.cols - 2; ++j)
+        for (int i = std::max(rowBegin, 2); i < std::min(rowEnd, input.rows - 2); ++i)
         {
-            // Separate channels
-            for (int c = 0; c < src.channels(); ++c)
+            uchar *dptr = dst.ptr<uchar>(i);
+            for (int j = 2; j < input.cols - 2; ++j)
             {
-                int sum = 0;
-                // Apply the blur filter
-                for (int m = -2; m <= 2; ++m)
+                // Separate channels
+                for (int c = 0; c < cn; ++c)
                 {
-                    for (int n = -2; n <= 2; ++n)
+                    int sum = 0;
+                    // Apply the blur filter
+                    for (int m = -2; m <= 2; ++m)
                     {
-                        sum += src.at<cv::Vec3b>(i + m, j + n)[c] * kernel[m + 2][n + 2];
+                        const uchar *rowptr = input.ptr<uchar>(i + m);
+                        for (int n = -2; n <= 2; ++n)
+                        {
+                            sum += rowptr[(j + n) * cn + c] * kernel[m + 2][n + 2];
+                        }
                     }
+                    // Normalize and set the pixel value in the destination image
+                    // dst.at<cv::Vec3b>(i, j)[c] = <cv::uchar>(sum / 84);
+                    float normalizedValue = static_cast<float>(sum) / 84.0; // 84 is the sum of the kernel values
+                    // Clip the value to the valid range [0, 255]
+                    if (normalizedValue < 0.0)
+                        normalizedValue = 0.0;
+                    else if (normalizedValue > 255.0)
+                        normalizedValue = 255.0;
+
+                    // Set the pixel value in the destination image
+                    dptr[j * cn + c] = static_cast<uchar>(normalizedValue);
                 }
-                // Normalize and set the pixel value in the destination image
-                // dst.at<cv::Vec3b>(i, j)[c] = <cv::uchar>(sum / 84);
-                float normalizedValue = static_cast<float>(sum) / 84.0; // 84 is the sum of the kernel values
-                // Clip the value to the valid range [0, 255]
-                if (normalizedValue < 0.0)
-                    normalizedValue = 0.0;
-                else if (normalizedValue > 255.0)
-                    normalizedValue = 255.0;
-
-                // Set the pixel value in the destination image
-                dst.at<cv::Vec3b>(i, j)[c] = static_cast<uchar>(normalizedValue);
             }
         }
-    }
+    });
     return 0;
 }
 
-int blur5x5_2(cv::Mat &src, cv::Mat &dst)
-{
-    dst = cv::Mat::zeros(src.size(), src.type());
-    cv::Mat temp = cv::Mat::zeros(src.size(), src.type());
-
-    // row filter
-    for (int i = 2; i < src.rows - 2; i++)
-    {
-        cv::Vec3b *rowptr = src.ptr<cv::Vec3b>(i);
-        cv::Vec3b *tempptr = temp.ptr<cv::Vec3b>(i);
+// the separable kernels of this file besides the shared Blur5 (kernelBands.h)
+typedef SeparableFilter<Taps<1, 6, 15, 20, 15, 6, 1>, Taps<1, 6, 15, 20, 15, 6, 1> > Gauss7;
 
-        // loop over columns
-        for (int j = 2; j < src.cols - 2; j++)
-        {
-            // loop over color channels
-            for (int c = 0; c < 3; c++)
-            {
-                // row filter [1 , 2, 4, 2, 1]
-                tempptr[j][c] = (1 * rowptr[j - 2][c] + 2 * rowptr[j - 1][c] + 4 * rowptr[j][c] + 2 * rowptr[j + 1][c] + 1 * rowptr[j + 2][c]) / 10.0;
-            }
-        }
-    }
+int gaussian7x7(cv::Mat &src, cv::Mat &dst)
+{
+    FilterWorkspace ws;
+    return gaussian7x7(src, dst, ws);
+}
 
-    // column filter
-    for (int i = 2; i < src.rows - 2; i++)
+int gaussian7x7(cv::Mat &src, cv::Mat &dst, FilterWorkspace &ws)
+{
+    if (!isFilterInput(src))
     {
-        cv::Vec3b *rowptrm2 = temp.ptr<cv::Vec3b>(i - 2);
-        cv::Vec3b *rowptrm1 = temp.ptr<cv::Vec3b>(i - 1);
-        cv::Vec3b *rowptr = temp.ptr<cv::Vec3b>(i);
-        cv::Vec3b *rowptrp1 = temp.ptr<cv::Vec3b>(i + 1);
-        cv::Vec3b *rowptrp2 = temp.ptr<cv::Vec3b>(i + 2);
-
-        cv::Vec3b *dptr = dst.ptr<cv::Vec3b>(i);
-
-        // loop over columns
-        for (int j = 2; j < src.cols - 2; j++)
-        {
-            // loop over color channels
-            for (int c = 0; c < 3; c++)
-            {
-                /*column filter
-                    [1]  m2
-                    [2]  m1
-                    [4]  r
-                    [2]  p1
-                    [1]  p2
-                */
-                dptr[j][c] = (1 * rowptrm2[j][c] + 2 * rowptrm1[j][c] + 4 * rowptr[j][c] + 2 * rowptrp1[j][c] + 1 * rowptrp2[j][c]) / 10.0;
-                // clip b/w 0 and 255
-                dptr[j][c] = dptr[j][c] > 255 ? 255 : dptr[j][c];
-            }
-        }
+        return -1;
     }
-
-    return 0; // Success
+    return smoothRows<Gauss7>(src, dst, ws, NULL);
 }
 
 #if 0
@@ -265,176 +327,800 @@ int sobelY3x3(cv::Mat& src, cv::Mat& dst) {
 }
 #endif
 
-int sobelX3x3(cv::Mat &src, cv::Mat &dst)
+int sobelMagnitude3x3(cv::Mat &src, cv::Mat *gx, cv::Mat *gy, cv::Mat *mag, cv::Mat *orientation)
 {
-    cv::Mat temp = src.clone();
-    dst = cv::Mat::zeros(src.size(), CV_16SC3);
+    FilterWorkspace ws;
+    return sobelMagnitude3x3(src, gx, gy, mag, orientation, ws);
+}
+
+int sobelMagnitude3x3(cv::Mat &src, cv::Mat *gx, cv::Mat *gy, cv::Mat *mag, cv::Mat *orientation, FilterWorkspace &ws)
+{
+    if (!isFilterInput(src))
+    {
+        return -1;
+    }
+
+    // bands read halo rows from src, so work from a copy if any output shares its data
+    cv::Mat input = src;
+    if ((gx && gx->data == src.data) || (gy && gy->data == src.data) ||
+        (mag && mag->data == src.data) || (orientation && orientation->data == src.data))
+    {
+        src.copyTo(ws.inputCopy());
+        input = ws.inputCopy();
+    }
 
-    // horizontal filter 
-    for (int i = 0; i < src.rows; i++)
+    const int cn = input.channels();
+    const int rows = input.rows;
+    const int cols = input.cols;
+    if (gx)
+        gx->create(input.size(), CV_MAKETYPE(CV_16S, cn));
+    if (gy)
+        gy->create(input.size(), CV_MAKETYPE(CV_16S, cn));
+    if (mag)
+        mag->create(input.size(), CV_MAKETYPE(CV_8U, cn));
+    if (orientation)
+        orientation->create(input.size(), CV_MAKETYPE(CV_32F, cn));
+
+    const int width = cols * cn;
+    const int first = cn;          // first interior element of a row
+    const int n = width - 2 * cn;  // interior elements per row
+
+    // zero the one-pixel border of a row of every requested output
+    auto clearRow = [&](int i, bool whole)
     {
-        cv::Vec3b *tempptr = temp.ptr<cv::Vec3b>(i);
-        cv::Vec3b *rowptr = src.ptr<cv::Vec3b>(i);
-        for (int j = 1; j < src.cols - 1; j++)
+        int len = whole ? width : first;
+        if (gx)
         {
-            for (int c = 0; c < 3; c++)
+            memset(gx->ptr<short>(i), 0, len * sizeof(short));
+            memset(gx->ptr<short>(i) + width - len, 0, len * sizeof(short));
+        }
+        if (gy)
+        {
+            memset(gy->ptr<short>(i), 0, len * sizeof(short));
+            memset(gy->ptr<short>(i) + width - len, 0, len * sizeof(short));
+        }
+        if (mag)
+        {
+            memset(mag->ptr<uchar>(i), 0, len);
+            memset(mag->ptr<uchar>(i) + width - len, 0, len);
+        }
+        if (orientation)
+        {
+            memset(orientation->ptr<float>(i), 0, len * sizeof(float));
+            memset(orientation->ptr<float>(i) + width - len, 0, len * sizeof(float));
+        }
+    };
+
+    if (rows < 3 || cols < 3)
+    {
+        for (int i = 0; i < rows; i++)
+        {
+            clearRow(i, true);
+        }
+        return 0;
+    }
+
+    // 3-row rolling buffers of the horizontal derivative and smoothing sums, per band and
+    // one column tile wide
+    const FilterKernels &kernels = filterKernels();
+    const int tile = tileBytes(n, cn, 6 * sizeof(short));
+    const int bands = bandCount(rows);
+    const size_t ringBytes = bandStride(6 * tile * sizeof(short));
+    uchar *rings = ws.scratch(bands * ringBytes);
+
+    forEachBand(rows, bands, [&](int band, int rowBegin, int rowEnd)
+    {
+        const int begin = std::max(rowBegin, 1);
+        const int end = std::min(rowEnd, rows - 1);
+        if (begin >= end)
+        {
+            return;
+        }
+
+        short *ring = (short *)(rings + band * ringBytes);
+        short *dRows[3], *mRows[3];
+        for (int r = 0; r < 3; r++)
+        {
+            dRows[r] = ring + (2 * r) * tile;
+            mRows[r] = ring + (2 * r + 1) * tile;
+        }
+
+        for (int x = first; x < first + n; x += tile)
+        {
+            const int w = std::min(tile, first + n - x);
+
+            for (int i = begin - 1; i < begin + 1; i++)
+            {
+                kernels.sobelRow(input.ptr<uchar>(i) + x, dRows[i % 3], mRows[i % 3], w, cn);
+            }
+
+            for (int i = begin; i < end; i++)
             {
-                tempptr[j][c] = static_cast<uchar>(
-                    (-1 * rowptr[j - 1][c] +
-                     1 * rowptr[j + 1][c]) /
-                        2.0 +
-                    0.5);
+                kernels.sobelRow(input.ptr<uchar>(i + 1) + x, dRows[(i + 1) % 3], mRows[(i + 1) % 3], w, cn);
+
+                /*
+                    gx = [1 2 1]^T * d      gy = [-1 0 1]^T * m
+                */
+                kernels.sobelCombine(dRows[(i - 1) % 3], dRows[i % 3], dRows[(i + 1) % 3],
+                                     mRows[(i - 1) % 3], mRows[(i + 1) % 3],
+                                     gx ? gx->ptr<short>(i) + x : NULL,
+                                     gy ? gy->ptr<short>(i) + x : NULL,
+                                     mag ? mag->ptr<uchar>(i) + x : NULL,
+                                     orientation ? orientation->ptr<float>(i) + x : NULL,
+                                     w);
             }
         }
+
+        for (int i = begin; i < end; i++)
+        {
+            clearRow(i, false);
+        }
+    });
+
+    // one-row border stays black
+    clearRow(0, true);
+    clearRow(rows - 1, true);
+
+    return 0;
+}
+
+int quantize(cv::Mat &src, cv::Mat &dst, int levels)
+{
+    if (src.depth() != CV_8U || levels <= 0)
+    {
+        return -1;
     }
 
-    // vertical filter
-    for (int i = 1; i < src.rows - 1; i++)
+    // one divide per possible value instead of one per byte
+    uchar table[256];
+    buildQuantizeTable(table, levels);
+
+    // pointwise, so dst may alias src
+    dst.create(src.size(), src.type());
+
+    const int width = src.cols * src.channels();
+    forEachBand(src.rows, [&](int rowBegin, int rowEnd)
     {
-        cv::Vec3s *dptr = dst.ptr<cv::Vec3s>(i);
-        cv::Vec3b *tempptrm1 = temp.ptr<cv::Vec3b>(i - 1);
-        cv::Vec3b *tempptr = temp.ptr<cv::Vec3b>(i);
-        cv::Vec3b *tempptrp1 = temp.ptr<cv::Vec3b>(i + 1);
-        for (int j = 0; j < src.cols; j++)
+        for (int i = rowBegin; i < rowEnd; i++)
         {
-            for (int c = 0; c < 3; c++)
+            lookupRow(src.ptr<uchar>(i), dst.ptr<uchar>(i), width, table);
+        }
+    });
+
+    return 0;
+}
+
+int blurQuantize(cv::Mat &src, cv::Mat &dst, int levels)
+{
+    FilterWorkspace ws;
+    return blurQuantize(src, dst, levels, ws);
+}
+
+int blurQuantize(cv::Mat &src, cv::Mat &dst, int levels, FilterWorkspace &ws)
+{
+    if (!isFilterInput(src) || levels <= 0)
+    {
+        return -1;
+    }
+
+    // one pass: each blurred row goes through the quantization table as it is written,
+    // the border stays black since level 0 is 0
+    return smoothRows<Blur5>(src, dst, ws, ws.quantizeTable(levels));
+}
+
+// Weights of the recursive filter for one iteration: table[d] = a^(1 + d * sigmaSpace / sigmaColor)
+// for a summed colour difference d to the neighbour, where a = exp(-sqrt(2) / sigma) is the share
+// a pixel takes from its neighbour on flat ground at the iteration's spatial sigma
+static void buildDomainWeights(float *table, int size, float sigma, float ratio)
+{
+    const float k = -std::sqrt(2.0f) / sigma;
+    for (int d = 0; d < size; d++)
+    {
+        table[d] = std::exp(k * (1 + ratio * d));
+    }
+}
+
+// Summed absolute channel difference of every guide pixel to its left (dh) and upper (dv)
+// neighbour, rows [rowBegin, rowEnd); the first column and row have no neighbour and get 0
+template <int GC>
+static void domainDiffs(const cv::Mat &guide, ushort *dh, ushort *dv, int rowBegin, int rowEnd)
+{
+    const int cols = guide.cols;
+    for (int i = rowBegin; i < rowEnd; i++)
+    {
+        const uchar *g = guide.ptr<uchar>(i);
+        const uchar *up = guide.ptr<uchar>(std::max(i - 1, 0));
+        ushort *h = dh + (size_t)i * cols;
+        ushort *v = dv + (size_t)i * cols;
+        h[0] = 0;
+        for (int j = 1; j < cols; j++)
+        {
+            int sum = 0;
+            for (int c = 0; c < GC; c++)
+            {
+                sum += std::abs(g[j * GC + c] - g[(j - 1) * GC + c]);
+            }
+            h[j] = (ushort)sum;
+        }
+        for (int j = 0; j < cols; j++)
+        {
+            int sum = 0;
+            for (int c = 0; c < GC; c++)
             {
-                dptr[j][c] = static_cast<short>(
-                    (1 * tempptrm1[j][c] +
-                     2 * tempptr[j][c] +
-                     1 * tempptrp1[j][c]) /
-                        4.0 +
-                    0.5);
+                sum += std::abs(g[j * GC + c] - up[j * GC + c]);
             }
+            v[j] = (ushort)sum;
+        }
+        if (i == 0)
+        {
+            memset(v, 0, cols * sizeof(ushort));
         }
     }
+}
 
-    return 0;
+// Rows filtered side by side by domainRows, enough independent recursions to keep the
+// multiply-adds busy while each one waits for the pixel before it
+static const int domainRowGroup = 4;
+
+// Forward then backward recursion along R rows of cols pixels, step floats apart: pixel j
+// moves w[diff[j]] of the way towards pixel j - 1, then w[diff[j + 1]] of the way towards
+// pixel j + 1. The running value of each row is kept in a register rather than read back.
+template <int CN, int R>
+static void domainRows(float *y, size_t step, const ushort *diff, int cols, const float *w)
+{
+    float last[R][CN];
+    for (int r = 0; r < R; r++)
+    {
+        for (int c = 0; c < CN; c++)
+        {
+            last[r][c] = y[r * step + c];
+        }
+    }
+    for (int j = 1; j < cols; j++)
+    {
+        for (int r = 0; r < R; r++)
+        {
+            float *p = y + r * step + j * CN;
+            const float a = w[diff[r * cols + j]];
+            for (int c = 0; c < CN; c++)
+            {
+                last[r][c] = p[c] + a * (last[r][c] - p[c]);
+                p[c] = last[r][c];
+            }
+        }
+    }
+    for (int j = cols - 2; j >= 0; j--)
+    {
+        for (int r = 0; r < R; r++)
+        {
+            float *p = y + r * step + j * CN;
+            const float a = w[diff[r * cols + j + 1]];
+            for (int c = 0; c < CN; c++)
+            {
+                last[r][c] = p[c] + a * (last[r][c] - p[c]);
+                p[c] = last[r][c];
+            }
+        }
+    }
 }
 
-int sobelY3x3(cv::Mat &src, cv::Mat &dst)
+// One step of the recursion down the columns: every value of row y moves a[k] of the way
+// towards the value of row prev above (or below) it. The columns are independent, so
+// unlike domainRows this loop vectorizes.
+static void domainStep(float *y, const float *prev, const float *a, int n)
 {
-    cv::Mat temp = src.clone();
-    dst = cv::Mat::zeros(src.size(), CV_16SC3);
+    SEPARABLE_NO_ALIAS
+    for (int k = 0; k < n; k++)
+    {
+        y[k] += a[k] * (prev[k] - y[k]);
+    }
+}
 
-    // vertical filter
-    for (int i = 1; i < src.rows - 1; i++)
+// Looks up the weight of every pixel of a row once per channel, so domainStep needs no lookups
+template <int CN>
+static void domainWeights(float *a, const ushort *diff, int n, const float *w)
+{
+    for (int j = 0; j < n; j++)
     {
-        cv::Vec3b *tempptr = temp.ptr<cv::Vec3b>(i);
-        cv::Vec3b *rowptrm1 = src.ptr<cv::Vec3b>(i - 1);
-        cv::Vec3b *rowptrp1 = src.ptr<cv::Vec3b>(i + 1);
-        for (int j = 0; j < src.cols; j++)
+        const float v = w[diff[j]];
+        for (int c = 0; c < CN; c++)
         {
-            for (int c = 0; c < 3; c++)
+            a[j * CN + c] = v;
+        }
+    }
+}
+
+template <int CN>
+static void domainTransform(const cv::Mat &input, cv::Mat &dst, const cv::Mat &guide, float sigmaSpace,
+                            float sigmaColor, int iterations, FilterWorkspace &ws)
+{
+    const int rows = input.rows;
+    const int cols = input.cols;
+    const size_t pixels = (size_t)rows * cols;
+    const size_t step = (size_t)cols * CN;
+
+    // a float copy of the image the passes work on in place, the colour differences between
+    // neighbours, which stay the same from one iteration to the next, and a row of weights
+    const size_t imageBytes = bandStride(pixels * CN * sizeof(float));
+    const size_t diffBytes = bandStride(pixels * sizeof(ushort));
+    uchar *memory = ws.scratch(imageBytes + 2 * diffBytes + step * sizeof(float));
+    float *y = (float *)memory;
+    ushort *dh = (ushort *)(memory + imageBytes);
+    ushort *dv = (ushort *)(memory + imageBytes + diffBytes);
+    float *weights = (float *)(memory + imageBytes + 2 * diffBytes);
+
+    forEachBand(rows, [&](int rowBegin, int rowEnd)
+    {
+        if (guide.channels() == 3)
+        {
+            domainDiffs<3>(guide, dh, dv, rowBegin, rowEnd);
+        }
+        else
+        {
+            domainDiffs<1>(guide, dh, dv, rowBegin, rowEnd);
+        }
+        for (int i = rowBegin; i < rowEnd; i++)
+        {
+            const uchar *s = input.ptr<uchar>(i);
+            float *t = y + i * step;
+            for (size_t k = 0; k < step; k++)
             {
-                tempptr[j][c] = static_cast<uchar>(
-                    (-1 * rowptrm1[j][c] +
-                     1 * rowptrp1[j][c]) /
-                        2.0 +
-                    0.5);
+                t[k] = s[k];
             }
         }
+    });
+
+    const int tableSize = 255 * guide.channels() + 1;
+    float w[255 * 3 + 1];
+    const float ratio = sigmaSpace / sigmaColor;
+    for (int it = 0; it < iterations; it++)
+    {
+        // the spatial sigma halves every iteration, so that together they add up to sigmaSpace
+        // and the streaks the first iteration leaves along edges are smoothed out by the next
+        const float sigma = sigmaSpace * std::sqrt(3.0f) * std::pow(2.0f, (float)(iterations - it - 1)) /
+                            std::sqrt(std::pow(4.0f, (float)iterations) - 1);
+        buildDomainWeights(w, tableSize, sigma, ratio);
+
+        forEachBand(rows, [&](int rowBegin, int rowEnd)
+        {
+            int i = rowBegin;
+            for (; i + domainRowGroup <= rowEnd; i += domainRowGroup)
+            {
+                domainRows<CN, domainRowGroup>(y + i * step, step, dh + (size_t)i * cols, cols, w);
+            }
+            for (; i < rowEnd; i++)
+            {
+                domainRows<CN, 1>(y + i * step, step, dh + (size_t)i * cols, cols, w);
+            }
+        });
+
+        // the columns are split into bands here, each band walks down and back up the image
+        // with its own part of the weight row
+        forEachBand(cols, [&](int colBegin, int colEnd)
+        {
+            const int n = (colEnd - colBegin) * CN;
+            float *band = y + colBegin * CN;
+            float *a = weights + colBegin * CN;
+            for (int i = 1; i < rows; i++)
+            {
+                domainWeights<CN>(a, dv + (size_t)i * cols + colBegin, colEnd - colBegin, w);
+                domainStep(band + i * step, band + (i - 1) * step, a, n);
+            }
+            for (int i = rows - 2; i >= 0; i--)
+            {
+                domainWeights<CN>(a, dv + (size_t)(i + 1) * cols + colBegin, colEnd - colBegin, w);
+                domainStep(band + i * step, band + (i + 1) * step, a, n);
+            }
+        });
     }
 
-    // horizontal filter
-    for (int i = 0; i < src.rows; i++)
+    // every output is a weighted average of inputs, so it only needs rounding
+    forEachBand(rows, [&](int rowBegin, int rowEnd)
     {
-        cv::Vec3s *dptr = dst.ptr<cv::Vec3s>(i);
-        cv::Vec3b *tempptr = temp.ptr<cv::Vec3b>(i);
-        for (int j = 1; j < src.cols - 1; j++)
+        for (int i = rowBegin; i < rowEnd; i++)
         {
-            for (int c = 0; c < 3; c++)
+            const float *s = y + i * step;
+            uchar *d = dst.ptr<uchar>(i);
+            for (size_t k = 0; k < step; k++)
             {
-                dptr[j][c] = static_cast<short>(
-                    (1 * tempptr[j - 1][c] +
-                     2 * tempptr[j][c] +
-                     1 * tempptr[j + 1][c]) /
-                        4.0 +
-                    0.5);
+                d[k] = (uchar)(s[k] + 0.5f);
             }
         }
+    });
+}
+
+int domainTransformFilter(cv::Mat &src, cv::Mat &dst, const cv::Mat &guide, float sigmaSpace, float sigmaColor,
+                          int iterations, FilterWorkspace &ws)
+{
+    // keep a handle on the input, dst may be the same Mat as src
+    cv::Mat input = src;
+    cv::Mat edges = guide.empty() ? input : guide;
+    if ((input.type() != CV_8UC1 && input.type() != CV_8UC3) ||
+        (edges.type() != CV_8UC1 && edges.type() != CV_8UC3) || edges.size() != input.size() ||
+        iterations < 1 || iterations > 3 || !(sigmaSpace > 0) || !(sigmaColor > 0))
+    {
+        return -1;
+    }
+    // the guide is only read before dst is written, so dst may alias it as well
+    dst.create(input.size(), input.type());
+    if (input.empty())
+    {
+        return 0;
     }
 
+    if (input.channels() == 3)
+    {
+        domainTransform<3>(input, dst, edges, sigmaSpace, sigmaColor, iterations, ws);
+    }
+    else
+    {
+        domainTransform<1>(input, dst, edges, sigmaSpace, sigmaColor, iterations, ws);
+    }
     return 0;
 }
 
-int magnitude(cv::Mat &sobelX, cv::Mat &sobelY, cv::Mat &dst)
+// Parameters of cv::bilateralFilter in the comic book effect. Its 9 pixel window cuts the 75 pixel
+// spatial Gaussian off long before it falls, so it smooths like a flat disk; the spatial sigma the
+// domain transform gets instead is the one that came closest to it (highest PSNR) on test images.
+static const int comicDiameter = 9;
+static const double comicSigmaColor = 75;
+static const double comicSigmaSpace = 75;
+static const float comicDomainSigmaSpace = 3.0f;
+
+int bilateralSmooth(cv::Mat &src, cv::Mat &dst, int quality, FilterWorkspace &ws)
+{
+    if (quality == 0)
+    {
+        // cv::bilateralFilter cannot work in place
+        cv::Mat input = src;
+        if (dst.data == input.data)
+        {
+            input.copyTo(ws.inputCopy());
+            input = ws.inputCopy();
+        }
+        cv::bilateralFilter(input, dst, comicDiameter, comicSigmaColor, comicSigmaSpace);
+        return 0;
+    }
+    return domainTransformFilter(src, dst, cv::Mat(), comicDomainSigmaSpace, (float)comicSigmaColor, quality, ws);
+}
+
+int comicBookEffect(cv::Mat &input, cv::Mat &output)
 {
-    dst = cv::Mat::zeros(sobelX.size(), CV_8UC3);
+    FilterWorkspace ws;
+    return comicBookEffect(input, output, comicDefaultQuality, ws);
+}
 
-    // loop over columns
-    for (int i = 0; i < sobelX.rows; i++)
+int comicBookEffect(cv::Mat &input, cv::Mat &output, int quality, FilterWorkspace &ws)
+{
+    if (!isFilterInput(input) || quality < 0 || quality > 3)
     {
+        return -1;
+    }
 
-        // src row pointers
-        cv::Vec3s *sobelXrowptr = sobelX.ptr<cv::Vec3s>(i);
-        cv::Vec3s *sobelYrowptr = sobelY.ptr<cv::Vec3s>(i);
+    // smoothing while preserving edges
+    cv::Mat gray, thresholded, edges;
+    if (input.channels() == 1)
+    {
+        // a greyscale frame is its own guide
+        bilateralSmooth(input, gray, quality, ws);
+    }
+    else if (quality == 0)
+    {
+        // the reference: bilateral filter of the colour image
+        cv::Mat bilateralFiltered;
+        bilateralSmooth(input, bilateralFiltered, 0, ws);
+        cv::cvtColor(bilateralFiltered, gray, cv::COLOR_BGR2GRAY);
+    }
+    else
+    {
+        // with its weights fixed by the colour edges the domain transform is linear, so filtering
+        // the grey image gives the grey of the filtered colour image at a third of the work
+        cv::cvtColor(input, gray, cv::COLOR_BGR2GRAY);
+        domainTransformFilter(gray, gray, input, comicDomainSigmaSpace, (float)comicSigmaColor, quality, ws);
+    }
 
-        // destination ptr
-        cv::Vec3b *dptr = dst.ptr<cv::Vec3b>(i);
+    // adaptive thresholding
+    cv::adaptiveThreshold(gray, thresholded, 255, cv::ADAPTIVE_THRESH_MEAN_C, cv::THRESH_BINARY, 9, 9);
 
-        // loop over columns
-        for (int j = 0; j < sobelX.cols; j++)
+    // edge enhancement
+    cv::Canny(gray, edges, 50, 150);
+    cv::bitwise_and(thresholded, edges, output);
+
+    return 0;
+}
+
+// The luma of cv::cvtColor(COLOR_BGR2GRAY) in every channel: in 14-bit fixed point its weights
+// are OpenCV's own (1868, 9617, 4899) and the 0.5 offset rounds the same way
+static const ColorMatrix lumaMatrix = {{
+    {0.114f, 0.587f, 0.299f, 0.5f},
+    {0.114f, 0.587f, 0.299f, 0.5f},
+    {0.114f, 0.587f, 0.299f, 0.5f},
+}};
+
+// Covers the part of a size-sized image outside boxes with rectangles that do not overlap:
+// the image is cut into bands of rows where the same boxes cross every row, and each band
+// into the gaps between them. Boxes are few, so the quadratic searches cost nothing.
+static void regionsOutside(const cv::Size &size, const std::vector<cv::Rect> &boxes, std::vector<cv::Rect> &outside)
+{
+    const cv::Rect frame(0, 0, size.width, size.height);
+    outside.clear();
+    int y = 0;
+    while (y < size.height)
+    {
+        // the band ends where a box starts or ends
+        int bandEnd = size.height;
+        for (size_t b = 0; b < boxes.size(); b++)
         {
-            // loop over color channels
-            for (int c = 0; c < 3; c++)
+            const cv::Rect box = boxes[b] & frame;
+            if (box.empty())
+            {
+                continue;
+            }
+            if (box.y > y)
+            {
+                bandEnd = std::min(bandEnd, box.y);
+            }
+            else if (box.y + box.height > y)
+            {
+                bandEnd = std::min(bandEnd, box.y + box.height);
+            }
+        }
+
+        // walk the band left to right, skipping over the boxes that cross it
+        int x = 0;
+        while (x < size.width)
+        {
+            int gapEnd = size.width;
+            bool covered = false;
+            for (size_t b = 0; b < boxes.size(); b++)
+            {
+                const cv::Rect box = boxes[b] & frame;
+                if (box.empty() || box.y > y || box.y + box.height <= y)
+                {
+                    continue;
+                }
+                if (box.x <= x && x < box.x + box.width)
+                {
+                    x = box.x + box.width;
+                    covered = true;
+                    break;
+                }
+                if (box.x > x)
+                {
+                    gapEnd = std::min(gapEnd, box.x);
+                }
+            }
+            if (!covered)
             {
-                dptr[j][c] = sqrt((sobelXrowptr[j][c] * sobelXrowptr[j][c] + sobelYrowptr[j][c] * sobelYrowptr[j][c]));
+                outside.push_back(cv::Rect(x, y, gapEnd - x, bandEnd - y));
+                x = gapEnd;
             }
         }
+        y = bandEnd;
+    }
+}
+
+// Copies the boxes of src that are inside the image to dst (the same size and type)
+static void copyBoxes(const cv::Mat &src, cv::Mat &dst, const std::vector<cv::Rect> &boxes, int rowBegin, int rowEnd)
+{
+    const cv::Rect frame(0, 0, src.cols, src.rows);
+    const size_t pixelBytes = src.elemSize();
+    for (size_t b = 0; b < boxes.size(); b++)
+    {
+        const cv::Rect box = boxes[b] & frame;
+        for (int i = std::max(box.y, rowBegin); i < std::min(box.y + box.height, rowEnd); i++)
+        {
+            memcpy(dst.ptr<uchar>(i) + box.x * pixelBytes, src.ptr<uchar>(i) + box.x * pixelBytes, box.width * pixelBytes);
+        }
+    }
+}
+
+int greyOutside(cv::Mat &src, cv::Mat &dst, const std::vector<cv::Rect> &keep, FilterWorkspace &ws)
+{
+    if (src.type() != CV_8UC3)
+    {
+        return -1;
     }
+    // pointwise, so dst may alias src; the boxes then stay as they are
+    const bool copyKept = dst.data != src.data || dst.size() != src.size() || dst.type() != src.type();
+    dst.create(src.size(), src.type());
+
+    std::vector<cv::Rect> &outside = ws.regions();
+    regionsOutside(src.size(), keep, outside);
+    const ColorCoeffs luma = toFixedPoint(lumaMatrix);
+    const FilterKernels &kernels = filterKernels();
+
+    forEachBand(src.rows, [&](int rowBegin, int rowEnd)
+    {
+        for (size_t r = 0; r < outside.size(); r++)
+        {
+            const cv::Rect &region = outside[r];
+            for (int i = std::max(region.y, rowBegin); i < std::min(region.y + region.height, rowEnd); i++)
+            {
+                kernels.colorMatrixRow(src.ptr<uchar>(i) + 3 * region.x, dst.ptr<uchar>(i) + 3 * region.x, region.width,
+                                       luma);
+            }
+        }
+        if (copyKept)
+        {
+            copyBoxes(src, dst, keep, rowBegin, rowEnd);
+        }
+    });
 
     return 0;
 }
 
-int blurQuantize(cv::Mat &src, cv::Mat &dst, int levels)
+// Fraction bits of the vertical interpolation weights in blurOutside
+static const int upsampleShift = 8;
+
+// d[k] = a[k] + (b[k] - a[k]) * weight / 2^upsampleShift, rounded; 16-bit lanes are enough
+static void lerpRow(const uchar *a, const uchar *b, uchar *d, int n, int weight)
 {
-    dst = cv::Mat::zeros(src.size(), src.type());
+    const ushort wa = (ushort)((1 << upsampleShift) - weight);
+    const ushort wb = (ushort)weight;
+    const ushort round = 1 << (upsampleShift - 1);
+    for (int k = 0; k < n; k++)
+    {
+        d[k] = (uchar)((ushort)(a[k] * wa + b[k] * wb + round) >> upsampleShift);
+    }
+}
+
+int blurOutside(cv::Mat &src, cv::Mat &dst, const std::vector<cv::Rect> &keep, int levels, FilterWorkspace &ws)
+{
+    if (src.type() != CV_8UC3 || levels < 1 || levels > maxBlurLevels)
+    {
+        return -1;
+    }
+    if (src.empty())
+    {
+        dst.create(src.size(), src.type());
+        return 0;
+    }
 
-    // create a temporary image
-    cv::Mat tempImg;
-    tempImg = cv::Mat::zeros(src.size(), src.type());
+    // Gaussian pyramid: every level is blurred (5x5) and halved, so the blur radius doubles
+    // per level while the work shrinks to a quarter
+    const cv::Mat *level = &src;
+    for (int l = 1; l <= levels; l++)
+    {
+        cv::pyrDown(*level, ws.pyramid(l));
+        level = &ws.pyramid(l);
+    }
 
-    // calculate the quantization factor
-    int b;
-    b = 255 / levels;
+    // bilinear upsampling in two passes: the smallest level is stretched to the full width
+    // (few rows, so this is cheap), then only the rows of the regions outside the boxes are
+    // interpolated between two stretched rows
+    cv::Mat &wide = ws.pyramid(0);
+    cv::resize(*level, wide, cv::Size(src.cols, level->rows), 0, 0, cv::INTER_LINEAR);
 
-    cv::Mat x;
-    blur5x5_2(src, x);
+    // the pyramid is built, so dst may alias src from here on
+    const bool copyKept = dst.data != src.data || dst.size() != src.size() || dst.type() != src.type();
+    dst.create(src.size(), src.type());
 
-    for (int i = 0; i < x.rows; i++)
+    std::vector<cv::Rect> &outside = ws.regions();
+    regionsOutside(src.size(), keep, outside);
+
+    forEachBand(dst.rows, [&](int rowBegin, int rowEnd)
     {
-        cv::Vec3b *xrowptr = x.ptr<cv::Vec3b>(i);
-        cv::Vec3b *tempptr = tempImg.ptr<cv::Vec3b>(i);
-        cv::Vec3b *drowptr = dst.ptr<cv::Vec3b>(i);
-        for (int j = 0; j < x.cols; j++)
+        for (size_t r = 0; r < outside.size(); r++)
         {
-            for (int c = 0; c < 3; c++)
+            const cv::Rect &region = outside[r];
+            for (int i = std::max(region.y, rowBegin); i < std::min(region.y + region.height, rowEnd); i++)
             {
-                tempptr[j][c] = xrowptr[j][c] / b;
-                drowptr[j][c] = tempptr[j][c] * b;
+                // the same pixel-centre mapping as cv::resize, clamped at the borders
+                float pos = (i + 0.5f) * wide.rows / dst.rows - 0.5f;
+                pos = std::min(std::max(pos, 0.0f), (float)(wide.rows - 1));
+                const int first = (int)pos;
+                const int weight = cvRound((pos - first) * (1 << upsampleShift));
+                const int next = std::min(first + 1, wide.rows - 1);
+                lerpRow(wide.ptr<uchar>(first) + 3 * region.x, wide.ptr<uchar>(next) + 3 * region.x,
+                        dst.ptr<uchar>(i) + 3 * region.x, 3 * region.width, weight);
             }
         }
-    }
+        if (copyKept)
+        {
+            copyBoxes(src, dst, keep, rowBegin, rowEnd);
+        }
+    });
 
     return 0;
 }
 
-int comicBookEffect(cv::Mat &input, cv::Mat &output)
+int motionDetect(cv::Mat &src, cv::Mat *highlight, MotionModel &model, int threshold, int learnShift)
 {
-    // bilateral filter for smoothing while preserving edges
-    cv::Mat bilateralFiltered;
-    cv::bilateralFilter(input, bilateralFiltered, 9, 75, 75);
+    if (!isFilterInput(src) || threshold < 0 || threshold > 255 || learnShift < 1 || learnShift > 8)
+    {
+        return -1;
+    }
+    const int cn = src.channels();
+    const int rows = src.rows;
+    const int cols = src.cols;
+    const int tileCols = (cols + motionTileSize - 1) / motionTileSize;
+    const int tileRows = (rows + motionTileSize - 1) / motionTileSize;
 
-    cv::Mat gray, thresholded, edges;
-    cv::cvtColor(bilateralFiltered, gray, cv::COLOR_BGR2GRAY);
+    // a new size or type starts a new background
+    if (model.background.rows != rows || model.background.cols != cols * cn || model.motion.cols != cols)
+    {
+        model.frames = 0;
+    }
+    if (highlight)
+    {
+        // pointwise, so the highlight may be src
+        highlight->create(src.size(), src.type());
+    }
 
-    // adaptive thresholding
-    cv::adaptiveThreshold(gray, thresholded, 255, cv::ADAPTIVE_THRESH_MEAN_C, cv::THRESH_BINARY, 9, 9);
+    if (model.frames == 0)
+    {
+        model.background.create(rows, cols * cn, CV_16UC1);
+        model.motion.create(src.size(), CV_8UC1);
+        model.tileFlags.assign(tileCols * tileRows, 1);
+        forEachBand(rows, [&](int rowBegin, int rowEnd)
+        {
+            for (int i = rowBegin; i < rowEnd; i++)
+            {
+                const uchar *s = src.ptr<uchar>(i);
+                ushort *bg = model.background.ptr<ushort>(i);
+                for (int c = 0; c < cn; c++)
+                {
+                    for (int j = 0; j < cols; j++)
+                    {
+                        bg[c * cols + j] = (ushort)(s[cn * j + c] << 8);
+                    }
+                }
+                memset(model.motion.ptr<uchar>(i), 0, cols);
+                if (highlight && highlight->data != src.data)
+                {
+                    memcpy(highlight->ptr<uchar>(i), s, cols * cn);
+                }
+            }
+        });
+    }
+    else
+    {
+        // bands of whole tile rows, so no two bands write the same tile flag
+        const FilterKernels &kernels = filterKernels();
+        forEachBand(tileRows, bandCount(rows), [&](int, int tileBegin, int tileEnd)
+        {
+            memset(model.tileFlags.data() + tileBegin * tileCols, 0, (tileEnd - tileBegin) * tileCols);
+            for (int i = tileBegin * motionTileSize; i < std::min(tileEnd * motionTileSize, rows); i++)
+            {
+                uchar *tiles = model.tileFlags.data() + (i / motionTileSize) * tileCols;
+                uchar *out = highlight ? highlight->ptr<uchar>(i) : NULL;
+                if (cn == 3)
+                {
+                    kernels.motionRowBGR(src.ptr<uchar>(i), model.background.ptr<ushort>(i), model.motion.ptr<uchar>(i),
+                                         out, tiles, cols, threshold, learnShift);
+                }
+                else
+                {
+                    kernels.motionRowGrey(src.ptr<uchar>(i), model.background.ptr<ushort>(i), model.motion.ptr<uchar>(i),
+                                          out, tiles, cols, threshold, learnShift);
+                }
+            }
+        });
+    }
+    model.frames++;
 
-    // edge enhancement
-    cv::Canny(gray, edges, 50, 150);
-    cv::bitwise_and(thresholded, edges, output);
+    // runs of moving tiles along each tile row
+    model.changed.clear();
+    for (int t = 0; t < tileRows; t++)
+    {
+        const uchar *flags = model.tileFlags.data() + t * tileCols;
+        for (int u = 0; u < tileCols; u++)
+        {
+            if (!flags[u])
+            {
+                continue;
+            }
+            int end = u;
+            while (end < tileCols && flags[end])
+            {
+                end++;
+            }
+            cv::Rect run(u * motionTileSize, t * motionTileSize, (end - u) * motionTileSize, motionTileSize);
+            model.changed.push_back(run & cv::Rect(0, 0, cols, rows));
+            u = end;
+        }
+    }
 
     return 0;
 }
@@ -0,0 +1,778 @@
+/**
+ * author: Harshit Kumar and Khushi Neema
+ * date: Oct 17, 2026
+ * purpose: Chains the filters into a reusable effect pipeline ("filter graph").
+ *
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <sstream>
+#include "filterGraph.h"
+#include "filter.h"
+#include "faceDetect.h"
+
+// Kernel of a stage. dst is a buffer owned by the graph (or the caller's frame
+// for the last stage) and never aliases src.
+typedef int (*StageFn)(FilterContext &ctx, cv::Mat &src, cv::Mat &dst, int param);
+
+struct FilterStage
+{
+    const char *name;
+    const char *label;
+    cv::Scalar color;  // label colour
+    int defaultParam;  // -1 if the stage takes no parameter
+    int outType;       // output type, -1 for the type of the input
+    bool needsColor;   // greyscale input is converted back to BGR first
+    bool perChannel;   // filters every channel on its own, so it can run on one plane at a time
+    bool local;        // reads at most gateHalo pixels around each output pixel, so it can run on tiles
+    StageFn run;
+    const char *cheaper; // "name[:param]" of a cheaper stand-in at reduced quality, NULL if none
+};
+
+static const cv::Scalar red(0, 0, 255);
+static const cv::Scalar green(0, 255, 0);
+static const cv::Scalar blue(255, 0, 0);
+static const cv::Scalar magenta(255, 0, 255);
+
+// Finds the faces in src: boxes tracked from the previous frame, refreshed by the background detector.
+// At reduced quality the boxes of the previous frame are reused on all but every faceEvery-th frame.
+static void findFaces(FilterContext &ctx, cv::Mat &src)
+{
+    if (ctx.faceFrames++ % ctx.faceEvery != 0)
+    {
+        return;
+    }
+    // convert the image to greyscale
+    cv::cvtColor(src, ctx.grey, cv::COLOR_BGR2GRAY, 0);
+    ctx.tracker.update(ctx.grey, ctx.faces);
+}
+
+static int runOpenCVGrey(FilterContext &, cv::Mat &src, cv::Mat &dst, int)
+{
+    cv::cvtColor(src, dst, cv::COLOR_BGR2GRAY);
+    return 0;
+}
+
+static int runGreyscale(FilterContext &, cv::Mat &src, cv::Mat &dst, int)
+{
+    dst.create(src.size(), src.type());
+    return greyscale(src, dst);
+}
+
+static int runSepia(FilterContext &, cv::Mat &src, cv::Mat &dst, int)
+{
+    dst.create(src.size(), src.type());
+    return sepia(src, dst);
+}
+
+static int runWarm(FilterContext &, cv::Mat &src, cv::Mat &dst, int)
+{
+    return colorMatrix(src, dst, warmMatrix);
+}
+
+static int runCool(FilterContext &, cv::Mat &src, cv::Mat &dst, int)
+{
+    return colorMatrix(src, dst, coolMatrix);
+}
+
+static int runSwapRB(FilterContext &, cv::Mat &src, cv::Mat &dst, int)
+{
+    return colorMatrix(src, dst, swapRBMatrix);
+}
+
+static int runBlurSlow(FilterContext &ctx, cv::Mat &src, cv::Mat &dst, int)
+{
+    return blur5x5_1(src, dst, ctx.ws);
+}
+
+static int runBlur(FilterContext &ctx, cv::Mat &src, cv::Mat &dst, int)
+{
+    return blur5x5_2(src, dst, ctx.ws);
+}
+
+static int runGaussian(FilterContext &ctx, cv::Mat &src, cv::Mat &dst, int)
+{
+    return gaussian7x7(src, dst, ctx.ws);
+}
+
+static int runSobelX(FilterContext &ctx, cv::Mat &src, cv::Mat &dst, int)
+{
+    if (sobelX3x3(src, ctx.gx, ctx.ws) != 0)
+    {
+        return -1;
+    }
+    cv::convertScaleAbs(ctx.gx, dst);
+    return 0;
+}
+
+static int runSobelY(FilterContext &ctx, cv::Mat &src, cv::Mat &dst, int)
+{
+    if (sobelY3x3(src, ctx.gy, ctx.ws) != 0)
+    {
+        return -1;
+    }
+    cv::convertScaleAbs(ctx.gy, dst);
+    return 0;
+}
+
+static int runMagnitude(FilterContext &ctx, cv::Mat &src, cv::Mat &dst, int)
+{
+    // fused Sobel X/Y and gradient magnitude in one pass
+    return sobelMagnitude3x3(src, NULL, NULL, &dst, NULL, ctx.ws);
+}
+
+static int runQuantize(FilterContext &, cv::Mat &src, cv::Mat &dst, int levels)
+{
+    return quantize(src, dst, levels);
+}
+
+static int runBlurQuantize(FilterContext &ctx, cv::Mat &src, cv::Mat &dst, int levels)
+{
+    return blurQuantize(src, dst, levels, ctx.ws);
+}
+
+static int runFaces(FilterContext &ctx, cv::Mat &src, cv::Mat &dst, int)
+{
+    findFaces(ctx, src);
+    src.copyTo(dst);
+    // draw boxes around the faces
+    drawBoxes(dst, ctx.faces);
+    return 0;
+}
+
+static int runColorFace(FilterContext &ctx, cv::Mat &src, cv::Mat &dst, int)
+{
+    // Make the face colorful, while the rest of the image is greyscale: the faces are
+    // copied and only the pixels around them converted
+    findFaces(ctx, src);
+    if (greyOutside(src, dst, ctx.faces, ctx.ws) != 0)
+    {
+        return -1;
+    }
+    drawBoxes(dst, ctx.faces);
+    return 0;
+}
+
+static int runBlurBackground(FilterContext &ctx, cv::Mat &src, cv::Mat &dst, int levels)
+{
+    // Keep the faces sharp and blur everything else, through a pyramid of levels halvings
+    findFaces(ctx, src);
+    if (blurOutside(src, dst, ctx.faces, levels, ctx.ws) != 0)
+    {
+        return -1;
+    }
+    drawBoxes(dst, ctx.faces);
+    return 0;
+}
+
+static int runNegative(FilterContext &, cv::Mat &src, cv::Mat &dst, int)
+{
+    // 255 - x for 8-bit pixels
+    cv::bitwise_not(src, dst);
+    return 0;
+}
+
+static int runEmboss(FilterContext &ctx, cv::Mat &src, cv::Mat &dst, int)
+{
+    if (sobelMagnitude3x3(src, &ctx.gx, &ctx.gy, NULL, NULL, ctx.ws) != 0)
+    {
+        return -1;
+    }
+    // scale the raw Sobel response by 1/8 to the range of sobelX3x3 / sobelY3x3
+    cv::convertScaleAbs(ctx.gx, ctx.ax, 0.125);
+    cv::convertScaleAbs(ctx.gy, ctx.ay, 0.125);
+    cv::addWeighted(ctx.ax, 0.7071, ctx.ay, 0.7071, 0, dst);
+    return 0;
+}
+
+static int runComic(FilterContext &ctx, cv::Mat &src, cv::Mat &dst, int quality)
+{
+    return comicBookEffect(src, dst, quality, ctx.ws);
+}
+
+static int runComicReference(FilterContext &ctx, cv::Mat &src, cv::Mat &dst, int)
+{
+    // smoothed with cv::bilateralFilter, to compare against the default
+    return comicBookEffect(src, dst, 0, ctx.ws);
+}
+
+static int runMotion(FilterContext &ctx, cv::Mat &src, cv::Mat &dst, int threshold)
+{
+    // tints what moved against the running background
+    return motionDetect(src, &dst, ctx.motion, threshold);
+}
+
+static int runMotionMask(FilterContext &ctx, cv::Mat &src, cv::Mat &dst, int threshold)
+{
+    if (motionDetect(src, NULL, ctx.motion, threshold) != 0)
+    {
+        return -1;
+    }
+    ctx.motion.mask().copyTo(dst);
+    return 0;
+}
+
+static int runMotionGate(FilterContext &ctx, cv::Mat &src, cv::Mat &dst, int threshold)
+{
+    // passes the frame on, the graph then runs the local stages after it on the moving tiles only
+    if (motionDetect(src, NULL, ctx.motion, threshold) != 0)
+    {
+        return -1;
+    }
+    src.copyTo(dst);
+    return 0;
+}
+
+// every stage the graph knows, looked up by name
+static const FilterStage stages[] = {
+    {"cvgrey", "OpenCV Greyscale", red, -1, CV_8UC1, true, false, true, runOpenCVGrey, NULL},
+    {"greyscale", "Custom Greyscale", red, -1, -1, true, false, true, runGreyscale, NULL},
+    {"sepia", "Custom Sepia", red, -1, -1, true, false, true, runSepia, NULL},
+    {"warm", "Warm Tint", red, -1, -1, true, false, true, runWarm, NULL},
+    {"cool", "Cool Tint", blue, -1, -1, true, false, true, runCool, NULL},
+    {"swaprb", "Red and Blue Swapped", red, -1, -1, true, false, true, runSwapRB, NULL},
+    {"blurslow", "Custom Blur", red, -1, -1, false, true, true, runBlurSlow, "blur"},
+    {"blur", "Custom Blur (faster)", red, -1, -1, false, true, true, runBlur, NULL},
+    {"gauss7", "Gaussian Blur 7x7", red, -1, -1, false, true, true, runGaussian, "blur"},
+    {"sobelx", "SobelX", red, -1, -1, false, true, true, runSobelX, NULL},
+    {"sobely", "SobelY", red, -1, -1, false, true, true, runSobelY, NULL},
+    {"magnitude", "Gradient Image from Sobel X and Y", green, -1, -1, false, true, true, runMagnitude, NULL},
+    {"quantize", "Quantize", green, 10, -1, false, true, true, runQuantize, NULL},
+    {"blurquantize", "Blur and quantize", green, 10, -1, false, true, true, runBlurQuantize, NULL},
+    {"faces", "Face Detect", red, -1, -1, true, false, false, runFaces, NULL},
+    {"colorface", "Colorful Face", red, -1, -1, true, false, false, runColorFace, NULL},
+    {"blurbackground", "Blur background", red, 2, -1, true, false, false, runBlurBackground, NULL},
+    {"negative", "Negative Image", red, -1, -1, false, true, true, runNegative, NULL},
+    {"emboss", "Embossing Effect", green, -1, -1, false, true, true, runEmboss, NULL},
+    {"comic", "Comic Book Effect", magenta, comicDefaultQuality, CV_8UC1, false, false, false, runComic, "comic:1"},
+    {"comicref", "Comic Book Effect (bilateral)", magenta, -1, CV_8UC1, false, false, false, runComicReference, "comic:1"},
+    {"motion", "Motion Highlight", red, motionDefaultThreshold, -1, false, false, false, runMotion, NULL},
+    {"motionmask", "Motion Mask", red, motionDefaultThreshold, CV_8UC1, false, false, false, runMotionMask, NULL},
+    {"motiongate", "Moving Tiles Only", red, motionDefaultThreshold, -1, false, false, false, runMotionGate, NULL},
+};
+static const int stageCount = sizeof(stages) / sizeof(stages[0]);
+
+// adjacent stages that run as one fused kernel, the parameter comes from the second
+struct Fusion
+{
+    const char *first;
+    const char *second;
+    const char *fused;
+};
+static const Fusion fusions[] = {
+    {"blur", "quantize", "blurquantize"},
+};
+static const int fusionCount = sizeof(fusions) / sizeof(fusions[0]);
+
+static const FilterStage *findStage(const std::string &name)
+{
+    for (int i = 0; i < stageCount; i++)
+    {
+        if (name == stages[i].name)
+        {
+            return &stages[i];
+        }
+    }
+    return NULL;
+}
+
+static std::string trim(const std::string &s)
+{
+    size_t begin = s.find_first_not_of(" \t");
+    if (begin == std::string::npos)
+    {
+        return "";
+    }
+    size_t end = s.find_last_not_of(" \t");
+    return s.substr(begin, end - begin + 1);
+}
+
+// Looks up "name[:param]", the parameter defaults to the stage's own
+static const FilterStage *parseStage(const std::string &item, int &param)
+{
+    size_t colon = item.find(':');
+    const FilterStage *stage = findStage(item.substr(0, colon));
+    if (stage)
+    {
+        param = colon == std::string::npos ? stage->defaultParam : atoi(item.c_str() + colon + 1);
+    }
+    return stage;
+}
+
+std::string GraphQuality::describe() const
+{
+    std::ostringstream text;
+    if (scale > 1)
+    {
+        text << "1/" << scale << " resolution";
+    }
+    if (cheapStages)
+    {
+        text << (text.tellp() > 0 ? ", " : "") << "cheaper stages";
+    }
+    if (faceEvery > 1)
+    {
+        text << (text.tellp() > 0 ? ", " : "") << "faces every " << faceEvery << " frames";
+    }
+    return text.tellp() > 0 ? text.str() : "full quality";
+}
+
+FilterGraph::FilterGraph()
+    : plannedType(-1), planarRuns(false), gatedFrames(0)
+{
+    const char *env = getenv("PROJECT1_PLANAR");
+    planarRuns = env && atoi(env) != 0;
+    ctx.stats = NULL;
+    ctx.faceEvery = 1;
+    ctx.faceFrames = 0;
+}
+
+int FilterGraph::configure(const std::string &spec, std::string *error)
+{
+    // parse "name[:param]" items separated by '>' or ','
+    std::vector<Node> parsed;
+    std::string item;
+    std::string text = spec + ">";
+    for (size_t i = 0; i < text.size(); i++)
+    {
+        if (text[i] != '>' && text[i] != ',')
+        {
+            item += (char)tolower((unsigned char)text[i]);
+            continue;
+        }
+        std::string name = trim(item);
+        std::string param;
+        item.clear();
+        size_t colon = name.find(':');
+        if (colon != std::string::npos)
+        {
+            param = trim(name.substr(colon + 1));
+            name = trim(name.substr(0, colon));
+        }
+        if (name.empty() || name == "original" || name == "none")
+        {
+            continue;
+        }
+
+        Node node;
+        node.stage = findStage(name);
+        if (node.stage == NULL)
+        {
+            if (error)
+            {
+                *error = "unknown stage '" + name + "', expected one of: " + stageNames();
+            }
+            return -1;
+        }
+        node.param = node.stage->defaultParam;
+        if (!param.empty())
+        {
+            char *end;
+            long value = strtol(param.c_str(), &end, 10);
+            if (node.stage->defaultParam < 0 || *end != '\0' || value <= 0)
+            {
+                if (error)
+                {
+                    *error = "bad parameter '" + param + "' for stage '" + name + "'";
+                }
+                return -1;
+            }
+            node.param = (int)value;
+        }
+        parsed.push_back(node);
+    }
+
+    // plan: merge adjacent stages that have a fused kernel
+    std::vector<Node> planned;
+    for (size_t i = 0; i < parsed.size(); i++)
+    {
+        if (!planned.empty())
+        {
+            Node &prev = planned.back();
+            int f = 0;
+            for (; f < fusionCount; f++)
+            {
+                if (std::string(prev.stage->name) == fusions[f].first && std::string(parsed[i].stage->name) == fusions[f].second)
+                {
+                    break;
+                }
+            }
+            if (f < fusionCount)
+            {
+                prev.stage = findStage(fusions[f].fused);
+                prev.param = parsed[i].param;
+                continue;
+            }
+        }
+        planned.push_back(parsed[i]);
+    }
+
+    // stand-ins of the planned (possibly fused) stages, used at reduced quality
+    for (size_t i = 0; i < planned.size(); i++)
+    {
+        Node &n = planned[i];
+        n.cheapStage = n.stage->cheaper ? parseStage(n.stage->cheaper, n.cheapParam) : NULL;
+        // a stand-in that is the same stage with a higher parameter would not be cheaper
+        if (n.cheapStage == n.stage && n.cheapParam >= n.param)
+        {
+            n.cheapStage = NULL;
+        }
+    }
+
+    specText = spec;
+    nodes.swap(planned);
+    // buffers are (re)allocated on the next frame
+    plannedSize = cv::Size();
+    plannedType = -1;
+    return 0;
+}
+
+// Pixels around a moving tile that a gated stage rewrites as well, since a kernel spreads the
+// change that far; twice as many are read. Exact for local chains of total radius up to this
+static const int gateHalo = 4;
+
+// Whether a node runs the same way on one plane as on all three, at any quality
+static bool planeByPlane(const FilterStage *stage, const FilterStage *cheapStage)
+{
+    return stage->perChannel && (cheapStage == NULL || cheapStage->perChannel);
+}
+
+void FilterGraph::planBuffers(const cv::Mat &frame)
+{
+    // the local stages right after a motion gate run on its tiles
+    bool gate = false;
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        Node &n = nodes[i];
+        n.gated = gate && n.stage->local && (n.cheapStage == NULL || n.cheapStage->local);
+        gate = n.gated || n.stage->run == runMotionGate;
+    }
+    gatedFrames = 0;
+
+    int type = frame.type();
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        Node &n = nodes[i];
+        if (n.stage->needsColor && CV_MAT_CN(type) == 1)
+        {
+            n.in.create(frame.size(), CV_8UC3);
+            type = CV_8UC3;
+        }
+        else
+        {
+            n.in.release();
+        }
+
+        // a run of per-channel stages on colour frames: one split before it, one merge after
+        n.planarRun = 0;
+        if (planarRuns && CV_MAT_CN(type) == 3)
+        {
+            size_t end = i;
+            while (end < nodes.size() && !nodes[end].gated && planeByPlane(nodes[end].stage, nodes[end].cheapStage))
+            {
+                end++;
+            }
+            if (end - i >= 2)
+            {
+                for (int c = 0; c < 3; c++)
+                {
+                    split[c].create(frame.size(), CV_8UC1);
+                }
+                for (size_t k = i; k < end; k++)
+                {
+                    for (int c = 0; c < 3; c++)
+                    {
+                        nodes[k].planes[c].create(frame.size(), CV_8UC1);
+                    }
+                    nodes[k].in.release();
+                    nodes[k].out.release();
+                    nodes[k].tile.release();
+                }
+                n.planarRun = (int)(end - i);
+                nodes[end - 1].out.create(frame.size(), type);
+                i = end - 1;
+                continue;
+            }
+        }
+        for (int c = 0; c < 3; c++)
+        {
+            n.planes[c].release();
+        }
+
+        if (n.stage->outType >= 0)
+        {
+            type = n.stage->outType;
+        }
+        n.out.create(frame.size(), type);
+        if (n.gated)
+        {
+            n.tile.create(frame.size(), type);
+        }
+        else
+        {
+            n.tile.release();
+        }
+    }
+    plannedSize = frame.size();
+    plannedType = frame.type();
+}
+
+int FilterGraph::apply(cv::Mat &frame)
+{
+    if (nodes.empty())
+    {
+        return 0;
+    }
+    if (current.scale <= 1)
+    {
+        return applyChain(frame);
+    }
+
+    // run the chain on a smaller copy and scale the result back up to the size of the frame
+    const cv::Size size = frame.size();
+    cv::resize(frame, small, cv::Size(std::max(1, size.width / current.scale), std::max(1, size.height / current.scale)),
+               0, 0, cv::INTER_AREA);
+    if (applyChain(small) != 0)
+    {
+        return -1;
+    }
+    cv::resize(small, frame, size, 0, 0, cv::INTER_LINEAR);
+    return 0;
+}
+
+int FilterGraph::applyChain(cv::Mat &frame)
+{
+    if (frame.size() != plannedSize || frame.type() != plannedType)
+    {
+        planBuffers(frame);
+    }
+
+    // moving tiles of this frame, set once a motion gate ran unless the frame is processed whole
+    const std::vector<cv::Rect> *tiles = NULL;
+    cv::Mat *src = &frame;
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        Node &n = nodes[i];
+        if (n.planarRun > 0)
+        {
+            // every stage of the run reads the planes of the one before, the last one's
+            // planes are merged into its output (or the caller's frame, which the split copied)
+            cv::split(*src, split);
+            cv::Mat *planes = split;
+            const size_t last = i + n.planarRun - 1;
+            for (size_t k = i; k <= last; k++)
+            {
+                if (runNode(nodes[k], planes, nodes[k].planes, 3) != 0)
+                {
+                    return -1;
+                }
+                planes = nodes[k].planes;
+            }
+            cv::Mat *dst = last + 1 == nodes.size() ? &frame : &nodes[last].out;
+            cv::merge(planes, 3, *dst);
+            src = dst;
+            i = last;
+            continue;
+        }
+
+        if (n.stage->needsColor && src->channels() == 1)
+        {
+            cv::cvtColor(*src, n.in, cv::COLOR_GRAY2BGR);
+            src = &n.in;
+        }
+        if (n.gated && tiles)
+        {
+            if (runTiles(n, *src, *tiles) != 0)
+            {
+                return -1;
+            }
+            src = &n.out;
+            continue;
+        }
+
+        // the last stage writes straight into the caller's frame unless it reads from it; a
+        // gated stage keeps its output for the tiles that do not move on the next frames
+        cv::Mat *dst = (i + 1 == nodes.size() && src != &frame && !n.gated) ? &frame : &n.out;
+        if (runNode(n, src, dst, 1) != 0)
+        {
+            return -1;
+        }
+        src = dst;
+        if (n.stage->run == runMotionGate && gatedFrames++ % gateRefreshFrames != 0)
+        {
+            tiles = &ctx.motion.changedTiles();
+        }
+    }
+    // the frame leaves the processing thread, so it must not share a graph buffer
+    if (src != &frame)
+    {
+        src->copyTo(frame);
+    }
+    return 0;
+}
+
+// Runs the node (or its stand-in at reduced quality) on count images, timed as one stage
+int FilterGraph::runNode(Node &n, cv::Mat *src, cv::Mat *dst, int count)
+{
+    const bool cheap = current.cheapStages && n.cheapStage;
+    const FilterStage *stage = cheap ? n.cheapStage : n.stage;
+    StageTimer timer(ctx.stats, stage->name);
+    for (int c = 0; c < count; c++)
+    {
+        if (stage->run(ctx, src[c], dst[c], cheap ? n.cheapParam : n.param) != 0)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Runs a gated node on the moving tiles: each tile is filtered with a margin of 2 * gateHalo
+// pixels into n.tile, and the tile plus gateHalo pixels around it is copied into n.out
+int FilterGraph::runTiles(Node &n, cv::Mat &src, const std::vector<cv::Rect> &tiles)
+{
+    const bool cheap = current.cheapStages && n.cheapStage;
+    const FilterStage *stage = cheap ? n.cheapStage : n.stage;
+    const int param = cheap ? n.cheapParam : n.param;
+    const cv::Rect frame(0, 0, src.cols, src.rows);
+    StageTimer timer(ctx.stats, stage->name);
+    for (size_t t = 0; t < tiles.size(); t++)
+    {
+        const cv::Rect &tile = tiles[t];
+        const cv::Rect spill = cv::Rect(tile.x - gateHalo, tile.y - gateHalo, tile.width + 2 * gateHalo,
+                                        tile.height + 2 * gateHalo) & frame;
+        const cv::Rect read = cv::Rect(tile.x - 2 * gateHalo, tile.y - 2 * gateHalo,
+                                       tile.width + 4 * gateHalo, tile.height + 4 * gateHalo) & frame;
+        // views of the right size and type, so the kernel writes into them without allocating
+        cv::Mat in = src(read);
+        cv::Mat out = n.tile(cv::Rect(0, 0, read.width, read.height));
+        if (stage->run(ctx, in, out, param) != 0)
+        {
+            return -1;
+        }
+        cv::Mat kept = n.out(spill);
+        out(cv::Rect(spill.x - read.x, spill.y - read.y, spill.width, spill.height)).copyTo(kept);
+    }
+    return 0;
+}
+
+void FilterGraph::setPlanar(bool on)
+{
+    planarRuns = on;
+    // the runs are found when the buffers are planned on the next frame
+    plannedSize = cv::Size();
+    plannedType = -1;
+}
+
+void FilterGraph::setQuality(const GraphQuality &quality)
+{
+    current = quality;
+    current.scale = std::max(quality.scale, 1);
+    ctx.faceEvery = std::max(quality.faceEvery, 1);
+    // the boxes of the previous frame may be for another size, find them again on the next frame
+    ctx.faceFrames = 0;
+    // gated stages may have switched to their stand-ins, redo the whole frame once
+    gatedFrames = 0;
+}
+
+bool FilterGraph::hasCheaperStages() const
+{
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        if (nodes[i].cheapStage)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FilterGraph::isTemporal() const
+{
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        StageFn run = nodes[i].stage->run;
+        if (run == runMotion || run == runMotionMask || run == runMotionGate)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FilterGraph::usesFaces() const
+{
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        StageFn run = nodes[i].stage->run;
+        if (run == runFaces || run == runColorFace || run == runBlurBackground)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void FilterGraph::setStats(FrameStats *stats)
+{
+    ctx.stats = stats;
+    ctx.tracker.setStats(stats);
+}
+
+std::string FilterGraph::label() const
+{
+    if (nodes.empty())
+    {
+        return "Original Video";
+    }
+    std::string text;
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        if (i > 0)
+        {
+            text += " + ";
+        }
+        text += nodes[i].stage->label;
+    }
+    return text;
+}
+
+cv::Scalar FilterGraph::labelColor() const
+{
+    return nodes.empty() ? blue : nodes[0].stage->color;
+}
+
+std::string FilterGraph::plan() const
+{
+    if (nodes.empty())
+    {
+        return "original";
+    }
+    std::ostringstream text;
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        if (i > 0)
+        {
+            text << " > ";
+        }
+        text << nodes[i].stage->name;
+        if (nodes[i].stage->defaultParam >= 0)
+        {
+            text << "(" << nodes[i].param << ")";
+        }
+    }
+    return text.str();
+}
+
+std::string FilterGraph::stageNames()
+{
+    std::string names = "original";
+    for (int i = 0; i < stageCount; i++)
+    {
+        names += " ";
+        names += stages[i].name;
+    }
+    return names;
+}
@@ -0,0 +1,176 @@
+/**
+ * author: Harshit Kumar and Khushi Neema
+ * date: Oct 17, 2026
+ * purpose: Scalar row kernels of filter.cpp and the choice of instruction set at run time.
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include "filterKernels.h"
+
+void colorMatrixRowFrom(int k, const uchar *s, uchar *d, int n, const ColorCoeffs &c)
+{
+    for (; k < n; k++)
+    {
+        const int b = s[3 * k], g = s[3 * k + 1], r = s[3 * k + 2];
+        const int outB = (c.m[0][0] * b + c.m[0][1] * g + c.m[0][2] * r + c.offset[0]) >> colorShift;
+        const int outG = (c.m[1][0] * b + c.m[1][1] * g + c.m[1][2] * r + c.offset[1]) >> colorShift;
+        const int outR = (c.m[2][0] * b + c.m[2][1] * g + c.m[2][2] * r + c.offset[2]) >> colorShift;
+        d[3 * k] = cv::saturate_cast<uchar>(outB);
+        d[3 * k + 1] = cv::saturate_cast<uchar>(outG);
+        d[3 * k + 2] = cv::saturate_cast<uchar>(outR);
+    }
+}
+
+void sobelRowFrom(int k, const uchar *s, short *d, short *m, int n, int cn)
+{
+    for (; k < n; k++)
+    {
+        d[k] = s[k + cn] - s[k - cn];
+        m[k] = s[k - cn] + 2 * s[k] + s[k + cn];
+    }
+}
+
+void sobelCombineFrom(int k, const short *dm1, const short *d0, const short *dp1, const short *mm1,
+                      const short *mp1, short *gx, short *gy, uchar *mag, float *orient, int n)
+{
+    for (; k < n; k++)
+    {
+        int x = dm1[k] + 2 * d0[k] + dp1[k];
+        int y = mp1[k] - mm1[k];
+        if (gx)
+            gx[k] = static_cast<short>(x);
+        if (gy)
+            gy[k] = static_cast<short>(y);
+        if (mag)
+            mag[k] = static_cast<uchar>(std::nearbyint(std::sqrt((float)(x * x + y * y)) * 0.125f));
+        if (orient)
+            orient[k] = std::atan2((float)y, (float)x);
+    }
+}
+
+// The motion kernels from pixel k, CN interleaved channels
+template <int CN>
+static void motionRowFrom(int k, const uchar *s, ushort *bg, uchar *mask, uchar *out, uchar *tiles, int cols,
+                          int threshold, int shift)
+{
+    // tint of the moving pixels, averaged with them: red, or white for greyscale
+    const uchar tint[3] = {(uchar)(CN == 3 ? 0 : 255), 0, 255};
+    for (; k < cols; k++)
+    {
+        int x[CN];
+        int diff = 0;
+        for (int c = 0; c < CN; c++)
+        {
+            x[c] = s[CN * k + c];
+            ushort &b = bg[c * cols + k];
+            diff = std::max(diff, std::abs(x[c] - (b >> 8)));
+            b = (ushort)(b - (b >> shift) + (x[c] << (8 - shift)));
+        }
+        const bool moving = diff > threshold;
+        mask[k] = moving ? 255 : 0;
+        if (moving)
+        {
+            tiles[k / motionTileSize] = 1;
+        }
+        if (out)
+        {
+            for (int c = 0; c < CN; c++)
+            {
+                out[CN * k + c] = (uchar)(moving ? (x[c] + tint[c] + 1) >> 1 : x[c]);
+            }
+        }
+    }
+}
+
+void motionRowBGRFrom(int k, const uchar *s, ushort *bg, uchar *mask, uchar *out, uchar *tiles, int cols,
+                      int threshold, int shift)
+{
+    motionRowFrom<3>(k, s, bg, mask, out, tiles, cols, threshold, shift);
+}
+
+void motionRowGreyFrom(int k, const uchar *s, ushort *bg, uchar *mask, uchar *out, uchar *tiles, int cols,
+                       int threshold, int shift)
+{
+    motionRowFrom<1>(k, s, bg, mask, out, tiles, cols, threshold, shift);
+}
+
+static void scalarColorMatrixRow(const uchar *s, uchar *d, int n, const ColorCoeffs &c)
+{
+    colorMatrixRowFrom(0, s, d, n, c);
+}
+
+static void scalarSobelRow(const uchar *s, short *d, short *m, int n, int cn)
+{
+    sobelRowFrom(0, s, d, m, n, cn);
+}
+
+static void scalarSobelCombine(const short *dm1, const short *d0, const short *dp1, const short *mm1,
+                               const short *mp1, short *gx, short *gy, uchar *mag, float *orient, int n)
+{
+    sobelCombineFrom(0, dm1, d0, dp1, mm1, mp1, gx, gy, mag, orient, n);
+}
+
+static void scalarMotionRowBGR(const uchar *s, ushort *bg, uchar *mask, uchar *out, uchar *tiles, int cols,
+                               int threshold, int shift)
+{
+    motionRowBGRFrom(0, s, bg, mask, out, tiles, cols, threshold, shift);
+}
+
+static void scalarMotionRowGrey(const uchar *s, ushort *bg, uchar *mask, uchar *out, uchar *tiles, int cols,
+                                int threshold, int shift)
+{
+    motionRowGreyFrom(0, s, bg, mask, out, tiles, cols, threshold, shift);
+}
+
+static const FilterKernels scalarFilterKernels = {
+    "scalar", scalarColorMatrixRow, scalarSobelRow, scalarSobelCombine, scalarMotionRowBGR, scalarMotionRowGrey};
+
+// Position of an instruction set in the order scalar, sse4.1, avx2, avx512
+static int isaRank(const std::string &isa)
+{
+    const char *order[] = {"scalar", "sse4.1", "avx2", "avx512"};
+    for (int i = 0; i < 4; i++)
+    {
+        if (isa == order[i])
+        {
+            return i;
+        }
+    }
+    return 0;
+}
+
+// The best table no better than the image kernels' choice, which already took the CPU
+// and IMAGE_KERNELS_ISA into account
+static const FilterKernels *selectFilterKernels()
+{
+    const int rank = isaRank(imageKernels().isa);
+#ifdef PROJECT1_AVX2
+    if (rank >= isaRank(avx2FilterKernels.isa))
+    {
+        return &avx2FilterKernels;
+    }
+#endif
+#ifdef PROJECT1_SSE41
+    if (rank >= isaRank(sse41FilterKernels.isa))
+    {
+        return &sse41FilterKernels;
+    }
+#endif
+    (void)rank;
+    return &scalarFilterKernels;
+}
+
+const FilterKernels &filterKernels()
+{
+    static const FilterKernels *selected = selectFilterKernels();
+    return *selected;
+}
+
+const char *filterKernelsIsa()
+{
+    return filterKernels().isa;
+}
@@ -0,0 +1,187 @@
+/**
+ * author: Harshit Kumar and Khushi Neema
+ * date: Oct 17, 2026
+ * purpose: Row kernels of filter.cpp that have vector versions, picked for the CPU at run time.
+ *
+ */
+
+#ifndef FILTERKERNELS_H
+#define FILTERKERNELS_H
+
+#include "filter.h"
+
+// fraction bits of the fixed-point colour matrix coefficients
+const int colorShift = 14;
+
+// A ColorMatrix in fixed point: 16-bit coefficients and 32-bit offsets, both scaled by 2^colorShift
+struct ColorCoeffs
+{
+    int m[3][3];
+    int offset[3];
+};
+
+// Row kernels of one instruction set, the same way as the shared ImageKernels
+// (imageKernels.h): every version gives the same result to the bit.
+struct FilterKernels
+{
+    // "scalar", "sse4.1" or "avx2"
+    const char *isa;
+
+    // Applies the matrix to n interleaved BGR pixels, s and d may be the same row
+    void (*colorMatrixRow)(const uchar *s, uchar *d, int n, const ColorCoeffs &c);
+
+    // Horizontal half of the fused Sobel: d = [-1 0 1] and m = [1 2 1] over interleaved
+    // 8-bit pixels, n bytes starting at s, neighbours cn bytes apart.
+    void (*sobelRow)(const uchar *s, short *d, short *m, int n, int cn);
+
+    // Vertical half of the fused Sobel: combines three rows of d/m into gx, gy and the
+    // magnitude, each written only when its pointer is non-null.
+    void (*sobelCombine)(const short *dm1, const short *d0, const short *dp1, const short *mm1, const short *mp1,
+                         short *gx, short *gy, uchar *mag, float *orient, int n);
+
+    // Updates the background with one row of a frame and marks its moving pixels, in one
+    // pass: s is the row (BGR or greyscale), bg its background (one plane of cols 8.8
+    // means per channel), mask the row of the motion mask and out the row of the
+    // highlight (NULL if not wanted, may be s). tiles gets a 1 for every motionTileSize
+    // tile of the row that moved.
+    void (*motionRowBGR)(const uchar *s, ushort *bg, uchar *mask, uchar *out, uchar *tiles, int cols,
+                         int threshold, int shift);
+    void (*motionRowGrey)(const uchar *s, ushort *bg, uchar *mask, uchar *out, uchar *tiles, int cols,
+                          int threshold, int shift);
+};
+
+/**
+ * @brief Returns the kernels for the instruction set imageKernels() picked, or the best
+ * one below it this build has (there is no AVX-512 version).
+ * @return The kernel table, valid for the lifetime of the program.
+ */
+const FilterKernels &filterKernels();
+
+// tables of the other instruction sets, each in its own file built with that set
+// enabled (see CMakeLists.txt)
+extern const FilterKernels sse41FilterKernels;
+extern const FilterKernels avx2FilterKernels;
+
+// The scalar kernels, starting at element k (pixel k for the colour matrix and motion),
+// so a vector loop can hand them what it left over. Defined in filterKernels.cpp, the
+// file built without extra instruction sets.
+void colorMatrixRowFrom(int k, const uchar *s, uchar *d, int n, const ColorCoeffs &c);
+void sobelRowFrom(int k, const uchar *s, short *d, short *m, int n, int cn);
+void sobelCombineFrom(int k, const short *dm1, const short *d0, const short *dp1, const short *mm1,
+                      const short *mp1, short *gx, short *gy, uchar *mag, float *orient, int n);
+void motionRowBGRFrom(int k, const uchar *s, ushort *bg, uchar *mask, uchar *out, uchar *tiles, int cols,
+                      int threshold, int shift);
+void motionRowGreyFrom(int k, const uchar *s, ushort *bg, uchar *mask, uchar *out, uchar *tiles, int cols,
+                       int threshold, int shift);
+
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+
+// Helpers of the SSE4.1 and AVX2 files, static so each file keeps the copy built with
+// its own instruction set.
+
+// Splits 16 interleaved BGR pixels (48 bytes) into one 16-byte register per channel
+static inline void deinterleaveBGR(const uchar *s, __m128i &b, __m128i &g, __m128i &r)
+{
+    __m128i s0 = _mm_loadu_si128((const __m128i *)s);
+    __m128i s1 = _mm_loadu_si128((const __m128i *)(s + 16));
+    __m128i s2 = _mm_loadu_si128((const __m128i *)(s + 32));
+    b = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(s0, _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)),
+                                  _mm_shuffle_epi8(s1, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1))),
+                     _mm_shuffle_epi8(s2, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13)));
+    g = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(s0, _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)),
+                                  _mm_shuffle_epi8(s1, _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1))),
+                     _mm_shuffle_epi8(s2, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14)));
+    r = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(s0, _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)),
+                                  _mm_shuffle_epi8(s1, _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1))),
+                     _mm_shuffle_epi8(s2, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15)));
+}
+
+// Inverse of deinterleaveBGR: writes 16 BGR pixels from one register per channel
+static inline void interleaveBGR(__m128i b, __m128i g, __m128i r, uchar *d)
+{
+    __m128i d0 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(b, _mm_setr_epi8(0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1, -1, 5)),
+                                           _mm_shuffle_epi8(g, _mm_setr_epi8(-1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1, -1))),
+                              _mm_shuffle_epi8(r, _mm_setr_epi8(-1, -1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1)));
+    __m128i d1 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(b, _mm_setr_epi8(-1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1, 10, -1)),
+                                           _mm_shuffle_epi8(g, _mm_setr_epi8(5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1, 10))),
+                              _mm_shuffle_epi8(r, _mm_setr_epi8(-1, 5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1)));
+    __m128i d2 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(b, _mm_setr_epi8(-1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1, -1)),
+                                           _mm_shuffle_epi8(g, _mm_setr_epi8(-1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1))),
+                              _mm_shuffle_epi8(r, _mm_setr_epi8(10, -1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15)));
+    _mm_storeu_si128((__m128i *)d, d0);
+    _mm_storeu_si128((__m128i *)(d + 16), d1);
+    _mm_storeu_si128((__m128i *)(d + 32), d2);
+}
+
+// Vector part of the motion kernels, 16 pixels at a time; both files use this one, the
+// AVX2 file only gets the VEX encoding. Returns the first pixel it left over.
+template <int CN>
+static int motionRowVector(const uchar *s, ushort *bg, uchar *mask, uchar *out, uchar *tiles, int cols,
+                           int threshold, int shift)
+{
+    // tint of the moving pixels, averaged with them: red, or white for greyscale
+    const uchar tint[3] = {(uchar)(CN == 3 ? 0 : 255), 0, 255};
+    const __m128i limit = _mm_set1_epi8((char)threshold);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i down = _mm_cvtsi32_si128(shift);     // bg >> shift
+    const __m128i up = _mm_cvtsi32_si128(8 - shift);   // x << (8 - shift)
+    int k = 0;
+    for (; k <= cols - 16; k += 16)
+    {
+        __m128i x[3];
+        if (CN == 3)
+        {
+            deinterleaveBGR(s + 3 * k, x[0], x[1], x[2]);
+        }
+        else
+        {
+            x[0] = _mm_loadu_si128((const __m128i *)(s + k));
+        }
+
+        __m128i diff = zero;
+        for (int c = 0; c < CN; c++)
+        {
+            ushort *b = bg + c * cols + k;
+            __m128i lo = _mm_loadu_si128((const __m128i *)b);
+            __m128i hi = _mm_loadu_si128((const __m128i *)(b + 8));
+            // |x - mean| against the background before this frame
+            __m128i mean = _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8));
+            diff = _mm_max_epu8(diff, _mm_or_si128(_mm_subs_epu8(x[c], mean), _mm_subs_epu8(mean, x[c])));
+            // bg += x / 2^shift - bg / 2^shift, never leaves the 16-bit range
+            __m128i xlo = _mm_sll_epi16(_mm_unpacklo_epi8(x[c], zero), up);
+            __m128i xhi = _mm_sll_epi16(_mm_unpackhi_epi8(x[c], zero), up);
+            _mm_storeu_si128((__m128i *)b, _mm_add_epi16(_mm_sub_epi16(lo, _mm_srl_epi16(lo, down)), xlo));
+            _mm_storeu_si128((__m128i *)(b + 8), _mm_add_epi16(_mm_sub_epi16(hi, _mm_srl_epi16(hi, down)), xhi));
+        }
+
+        // moving where diff > threshold, i.e. diff - threshold does not saturate to 0
+        __m128i moving = _mm_xor_si128(_mm_cmpeq_epi8(_mm_subs_epu8(diff, limit), zero), _mm_set1_epi8(-1));
+        _mm_storeu_si128((__m128i *)(mask + k), moving);
+        if (_mm_movemask_epi8(moving))
+        {
+            // 16 pixels starting at a multiple of 16 lie in one tile
+            tiles[k / motionTileSize] = 1;
+        }
+
+        if (out)
+        {
+            for (int c = 0; c < CN; c++)
+            {
+                x[c] = _mm_blendv_epi8(x[c], _mm_avg_epu8(x[c], _mm_set1_epi8((char)tint[c])), moving);
+            }
+            if (CN == 3)
+            {
+                interleaveBGR(x[0], x[1], x[2], out + 3 * k);
+            }
+            else
+            {
+                _mm_storeu_si128((__m128i *)(out + k), x[0]);
+            }
+        }
+    }
+    return k;
+}
+#endif // __SSE4_1__
+
+#endif // FILTERKERNELS_H
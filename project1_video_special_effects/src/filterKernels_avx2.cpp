@@ -0,0 +1,124 @@
+/**
+ * author: Harshit Kumar and Khushi Neema
+ * date: Oct 17, 2026
+ * purpose: AVX2 row kernels of filter.cpp, built with -mavx2 and only run on CPUs that have it.
+ *
+ */
+
+#include <cmath>
+#include <immintrin.h>
+#include "filterKernels.h"
+
+// One output channel of 16 pixels: the (B, G) pairs and (R, 0) pairs go through madd
+// against the packed coefficients, the 32-bit sums are shifted down and saturated to 8 bits
+static inline __m128i mixChannel(__m256i bgLo, __m256i bgHi, __m256i r0Lo, __m256i r0Hi,
+                                 __m256i cbg, __m256i cr, __m256i offset)
+{
+    __m256i lo = _mm256_add_epi32(_mm256_add_epi32(_mm256_madd_epi16(bgLo, cbg), _mm256_madd_epi16(r0Lo, cr)), offset);
+    __m256i hi = _mm256_add_epi32(_mm256_add_epi32(_mm256_madd_epi16(bgHi, cbg), _mm256_madd_epi16(r0Hi, cr)), offset);
+    __m256i v = _mm256_packs_epi32(_mm256_srai_epi32(lo, colorShift), _mm256_srai_epi32(hi, colorShift));
+    // unpack and pack both work per 128-bit lane, so the pixels are back in order here
+    __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(v, v), 0x08);
+    return _mm256_castsi256_si128(packed);
+}
+
+static void colorMatrixRow(const uchar *s, uchar *d, int n, const ColorCoeffs &c)
+{
+    __m256i cbg[3], cr[3], offset[3];
+    for (int ch = 0; ch < 3; ch++)
+    {
+        cbg[ch] = _mm256_set1_epi32((c.m[ch][1] << 16) | (c.m[ch][0] & 0xffff));
+        cr[ch] = _mm256_set1_epi32(c.m[ch][2] & 0xffff);
+        offset[ch] = _mm256_set1_epi32(c.offset[ch]);
+    }
+    const __m256i zero = _mm256_setzero_si256();
+    int k = 0;
+    for (; k <= n - 16; k += 16)
+    {
+        __m128i b, g, r;
+        deinterleaveBGR(s + 3 * k, b, g, r);
+        __m256i b16 = _mm256_cvtepu8_epi16(b);
+        __m256i g16 = _mm256_cvtepu8_epi16(g);
+        __m256i r16 = _mm256_cvtepu8_epi16(r);
+        __m256i bgLo = _mm256_unpacklo_epi16(b16, g16);
+        __m256i bgHi = _mm256_unpackhi_epi16(b16, g16);
+        __m256i r0Lo = _mm256_unpacklo_epi16(r16, zero);
+        __m256i r0Hi = _mm256_unpackhi_epi16(r16, zero);
+        interleaveBGR(mixChannel(bgLo, bgHi, r0Lo, r0Hi, cbg[0], cr[0], offset[0]),
+                      mixChannel(bgLo, bgHi, r0Lo, r0Hi, cbg[1], cr[1], offset[1]),
+                      mixChannel(bgLo, bgHi, r0Lo, r0Hi, cbg[2], cr[2], offset[2]),
+                      d + 3 * k);
+    }
+    colorMatrixRowFrom(k, s, d, n, c);
+}
+
+static void sobelRow(const uchar *s, short *d, short *m, int n, int cn)
+{
+    int k = 0;
+    for (; k <= n - 16; k += 16)
+    {
+        __m256i l = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(s + k - cn)));
+        __m256i c = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(s + k)));
+        __m256i r = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(s + k + cn)));
+        _mm256_storeu_si256((__m256i *)(d + k), _mm256_sub_epi16(r, l));
+        _mm256_storeu_si256((__m256i *)(m + k), _mm256_add_epi16(_mm256_add_epi16(l, r), _mm256_slli_epi16(c, 1)));
+    }
+    sobelRowFrom(k, s, d, m, n, cn);
+}
+
+static void sobelCombine(const short *dm1, const short *d0, const short *dp1, const short *mm1, const short *mp1,
+                         short *gx, short *gy, uchar *mag, float *orient, int n)
+{
+    const __m256 eighth = _mm256_set1_ps(0.125f);
+    int k = 0;
+    for (; k <= n - 16; k += 16)
+    {
+        __m256i x = _mm256_add_epi16(_mm256_add_epi16(_mm256_loadu_si256((const __m256i *)(dm1 + k)),
+                                                      _mm256_loadu_si256((const __m256i *)(dp1 + k))),
+                                     _mm256_slli_epi16(_mm256_loadu_si256((const __m256i *)(d0 + k)), 1));
+        __m256i y = _mm256_sub_epi16(_mm256_loadu_si256((const __m256i *)(mp1 + k)),
+                                     _mm256_loadu_si256((const __m256i *)(mm1 + k)));
+        if (gx)
+            _mm256_storeu_si256((__m256i *)(gx + k), x);
+        if (gy)
+            _mm256_storeu_si256((__m256i *)(gy + k), y);
+        if (mag)
+        {
+            // x*x + y*y as 32-bit pairs, then sqrt / 8 in float
+            __m256i lo = _mm256_madd_epi16(_mm256_unpacklo_epi16(x, y), _mm256_unpacklo_epi16(x, y));
+            __m256i hi = _mm256_madd_epi16(_mm256_unpackhi_epi16(x, y), _mm256_unpackhi_epi16(x, y));
+            lo = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_sqrt_ps(_mm256_cvtepi32_ps(lo)), eighth));
+            hi = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_sqrt_ps(_mm256_cvtepi32_ps(hi)), eighth));
+            // the unpack/pack pairs are both per 128-bit lane, so lane order is restored here
+            __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(lo, hi), _mm256_setzero_si256());
+            packed = _mm256_permute4x64_epi64(packed, 0x08);
+            _mm_storeu_si128((__m128i *)(mag + k), _mm256_castsi256_si128(packed));
+        }
+        if (orient)
+        {
+            for (int t = 0; t < 16; t++)
+            {
+                orient[k + t] = std::atan2((float)(mp1[k + t] - mm1[k + t]),
+                                           (float)(dm1[k + t] + 2 * d0[k + t] + dp1[k + t]));
+            }
+        }
+    }
+    sobelCombineFrom(k, dm1, d0, dp1, mm1, mp1, gx, gy, mag, orient, n);
+}
+
+static void motionRowBGR(const uchar *s, ushort *bg, uchar *mask, uchar *out, uchar *tiles, int cols,
+                         int threshold, int shift)
+{
+    int k = motionRowVector<3>(s, bg, mask, out, tiles, cols, threshold, shift);
+    motionRowBGRFrom(k, s, bg, mask, out, tiles, cols, threshold, shift);
+}
+
+static void motionRowGrey(const uchar *s, ushort *bg, uchar *mask, uchar *out, uchar *tiles, int cols,
+                          int threshold, int shift)
+{
+    int k = motionRowVector<1>(s, bg, mask, out, tiles, cols, threshold, shift);
+    motionRowGreyFrom(k, s, bg, mask, out, tiles, cols, threshold, shift);
+}
+
+extern const FilterKernels avx2FilterKernels = {
+    "avx2", colorMatrixRow, sobelRow, sobelCombine, motionRowBGR, motionRowGrey};
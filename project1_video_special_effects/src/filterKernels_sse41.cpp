@@ -0,0 +1,124 @@
+/**
+ * author: Harshit Kumar and Khushi Neema
+ * date: Oct 17, 2026
+ * purpose: SSE4.1 row kernels of filter.cpp, built with -msse4.1 and only run on CPUs that have it.
+ *
+ */
+
+#include <cmath>
+#include "filterKernels.h"
+
+// One output channel of 8 pixels: the (B, G) pairs and (R, 0) pairs go through madd
+// against the packed coefficients, the 32-bit sums are shifted down and saturated to 16 bits
+static inline __m128i mixChannel(__m128i bgLo, __m128i bgHi, __m128i r0Lo, __m128i r0Hi,
+                                 __m128i cbg, __m128i cr, __m128i offset)
+{
+    __m128i lo = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(bgLo, cbg), _mm_madd_epi16(r0Lo, cr)), offset);
+    __m128i hi = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(bgHi, cbg), _mm_madd_epi16(r0Hi, cr)), offset);
+    return _mm_packs_epi32(_mm_srai_epi32(lo, colorShift), _mm_srai_epi32(hi, colorShift));
+}
+
+static void colorMatrixRow(const uchar *s, uchar *d, int n, const ColorCoeffs &c)
+{
+    __m128i cbg[3], cr[3], offset[3];
+    for (int ch = 0; ch < 3; ch++)
+    {
+        cbg[ch] = _mm_set1_epi32((c.m[ch][1] << 16) | (c.m[ch][0] & 0xffff));
+        cr[ch] = _mm_set1_epi32(c.m[ch][2] & 0xffff);
+        offset[ch] = _mm_set1_epi32(c.offset[ch]);
+    }
+    const __m128i zero = _mm_setzero_si128();
+    int k = 0;
+    for (; k <= n - 16; k += 16)
+    {
+        __m128i b, g, r;
+        deinterleaveBGR(s + 3 * k, b, g, r);
+        __m128i out[3];
+        // two halves of 8 pixels each
+        for (int half = 0; half < 2; half++)
+        {
+            __m128i b16 = _mm_cvtepu8_epi16(half ? _mm_srli_si128(b, 8) : b);
+            __m128i g16 = _mm_cvtepu8_epi16(half ? _mm_srli_si128(g, 8) : g);
+            __m128i r16 = _mm_cvtepu8_epi16(half ? _mm_srli_si128(r, 8) : r);
+            __m128i bgLo = _mm_unpacklo_epi16(b16, g16);
+            __m128i bgHi = _mm_unpackhi_epi16(b16, g16);
+            __m128i r0Lo = _mm_unpacklo_epi16(r16, zero);
+            __m128i r0Hi = _mm_unpackhi_epi16(r16, zero);
+            for (int ch = 0; ch < 3; ch++)
+            {
+                __m128i v = mixChannel(bgLo, bgHi, r0Lo, r0Hi, cbg[ch], cr[ch], offset[ch]);
+                out[ch] = half ? _mm_packus_epi16(out[ch], v) : v;
+            }
+        }
+        interleaveBGR(out[0], out[1], out[2], d + 3 * k);
+    }
+    colorMatrixRowFrom(k, s, d, n, c);
+}
+
+static void sobelRow(const uchar *s, short *d, short *m, int n, int cn)
+{
+    int k = 0;
+    for (; k <= n - 8; k += 8)
+    {
+        __m128i l = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)(s + k - cn)));
+        __m128i c = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)(s + k)));
+        __m128i r = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)(s + k + cn)));
+        _mm_storeu_si128((__m128i *)(d + k), _mm_sub_epi16(r, l));
+        _mm_storeu_si128((__m128i *)(m + k), _mm_add_epi16(_mm_add_epi16(l, r), _mm_slli_epi16(c, 1)));
+    }
+    sobelRowFrom(k, s, d, m, n, cn);
+}
+
+static void sobelCombine(const short *dm1, const short *d0, const short *dp1, const short *mm1, const short *mp1,
+                         short *gx, short *gy, uchar *mag, float *orient, int n)
+{
+    const __m128 eighth = _mm_set1_ps(0.125f);
+    int k = 0;
+    for (; k <= n - 8; k += 8)
+    {
+        __m128i x = _mm_add_epi16(_mm_add_epi16(_mm_loadu_si128((const __m128i *)(dm1 + k)),
+                                                _mm_loadu_si128((const __m128i *)(dp1 + k))),
+                                  _mm_slli_epi16(_mm_loadu_si128((const __m128i *)(d0 + k)), 1));
+        __m128i y = _mm_sub_epi16(_mm_loadu_si128((const __m128i *)(mp1 + k)),
+                                  _mm_loadu_si128((const __m128i *)(mm1 + k)));
+        if (gx)
+            _mm_storeu_si128((__m128i *)(gx + k), x);
+        if (gy)
+            _mm_storeu_si128((__m128i *)(gy + k), y);
+        if (mag)
+        {
+            // x*x + y*y as 32-bit pairs, then sqrt / 8 in float
+            __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi16(x, y), _mm_unpacklo_epi16(x, y));
+            __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi16(x, y), _mm_unpackhi_epi16(x, y));
+            lo = _mm_cvtps_epi32(_mm_mul_ps(_mm_sqrt_ps(_mm_cvtepi32_ps(lo)), eighth));
+            hi = _mm_cvtps_epi32(_mm_mul_ps(_mm_sqrt_ps(_mm_cvtepi32_ps(hi)), eighth));
+            _mm_storel_epi64((__m128i *)(mag + k), _mm_packus_epi16(_mm_packs_epi32(lo, hi), _mm_setzero_si128()));
+        }
+        if (orient)
+        {
+            for (int t = 0; t < 8; t++)
+            {
+                orient[k + t] = std::atan2((float)(mp1[k + t] - mm1[k + t]),
+                                           (float)(dm1[k + t] + 2 * d0[k + t] + dp1[k + t]));
+            }
+        }
+    }
+    sobelCombineFrom(k, dm1, d0, dp1, mm1, mp1, gx, gy, mag, orient, n);
+}
+
+static void motionRowBGR(const uchar *s, ushort *bg, uchar *mask, uchar *out, uchar *tiles, int cols,
+                         int threshold, int shift)
+{
+    int k = motionRowVector<3>(s, bg, mask, out, tiles, cols, threshold, shift);
+    motionRowBGRFrom(k, s, bg, mask, out, tiles, cols, threshold, shift);
+}
+
+static void motionRowGrey(const uchar *s, ushort *bg, uchar *mask, uchar *out, uchar *tiles, int cols,
+                          int threshold, int shift)
+{
+    int k = motionRowVector<1>(s, bg, mask, out, tiles, cols, threshold, shift);
+    motionRowGreyFrom(k, s, bg, mask, out, tiles, cols, threshold, shift);
+}
+
+extern const FilterKernels sse41FilterKernels = {
+    "sse4.1", colorMatrixRow, sobelRow, sobelCombine, motionRowBGR, motionRowGrey};
@@ -0,0 +1,305 @@
+/**
+ * author: Harshit Kumar and Khushi Neema
+ * date: Oct 17, 2026
+ * purpose: Processed frames published to other processes through a POSIX shared-memory ring.
+ *
+ */
+
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <new>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "frameRing.h"
+
+// the counters are shared between processes, which only works if they do not hide a lock
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "the frame ring needs lock-free 64-bit atomics");
+
+// "FRNG" in memory order, and the layout version readers check
+static const uint32_t ringMagic = 0x474e5246;
+static const uint32_t ringVersion = 1;
+
+// Start of the segment, one cache line
+struct alignas(64) RingHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slots;
+    uint32_t reserved;
+    uint64_t slotBytes;            // pixel bytes per slot
+    std::atomic<uint64_t> latest;  // newest complete frame, 0 before the first
+    std::atomic<uint32_t> closed;  // set when the writer goes away
+};
+
+// Start of every slot, followed by the pixels
+struct alignas(64) SlotHeader
+{
+    std::atomic<uint64_t> seq; // 2 * n - 1 while frame n is written, 2 * n once it is complete
+    int32_t rows;
+    int32_t cols;
+    int32_t type;
+    int32_t step;
+    double timestamp;
+};
+
+// slot size with its header, rounded up so every slot header starts a cache line
+static size_t slotStrideFor(size_t slotBytes)
+{
+    return (sizeof(SlotHeader) + slotBytes + 63) / 64 * 64;
+}
+
+static int fail(std::string *error, const std::string &message)
+{
+    if (error)
+    {
+        *error = message;
+    }
+    return -1;
+}
+
+FrameRingWriter::FrameRingWriter() : base(NULL), mapped(0), sequence(0), tooLarge(0)
+{
+}
+
+FrameRingWriter::~FrameRingWriter()
+{
+    close();
+}
+
+int FrameRingWriter::open(const std::string &name, size_t slotBytes, int slots, std::string *error)
+{
+    close();
+    if (slots < 2 || slotBytes == 0)
+    {
+        return fail(error, "a frame ring needs at least 2 slots of at least 1 byte");
+    }
+
+    // a ring left behind by a crashed writer is replaced, its readers keep the old mapping
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0)
+    {
+        return fail(error, "shm_open " + name + ": " + strerror(errno));
+    }
+    const size_t stride = slotStrideFor(slotBytes);
+    const size_t bytes = sizeof(RingHeader) + stride * slots;
+    if (ftruncate(fd, (off_t)bytes) != 0)
+    {
+        std::string reason = strerror(errno);
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return fail(error, "ftruncate " + name + ": " + reason);
+    }
+    void *memory = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    // the mapping keeps the segment, the descriptor is no longer needed
+    ::close(fd);
+    if (memory == MAP_FAILED)
+    {
+        std::string reason = strerror(errno);
+        shm_unlink(name.c_str());
+        return fail(error, "mmap " + name + ": " + reason);
+    }
+
+    base = static_cast<unsigned char *>(memory);
+    mapped = bytes;
+    this->name = name;
+    sequence = 0;
+    tooLarge = 0;
+
+    RingHeader *header = new (base) RingHeader;
+    header->version = ringVersion;
+    header->slots = (uint32_t)slots;
+    header->reserved = 0;
+    header->slotBytes = slotBytes;
+    header->latest.store(0, std::memory_order_relaxed);
+    header->closed.store(0, std::memory_order_relaxed);
+    for (int k = 0; k < slots; k++)
+    {
+        SlotHeader *slot = new (base + sizeof(RingHeader) + stride * k) SlotHeader;
+        slot->seq.store(0, std::memory_order_relaxed);
+    }
+    // readers check the magic last, so they never see a half-written header
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = ringMagic;
+    return 0;
+}
+
+int FrameRingWriter::publish(const cv::Mat &frame, double timestamp)
+{
+    if (!base)
+    {
+        return -1;
+    }
+    RingHeader *header = reinterpret_cast<RingHeader *>(base);
+    const size_t rowBytes = frame.cols * frame.elemSize();
+    if (frame.depth() != CV_8U || rowBytes * frame.rows > header->slotBytes)
+    {
+        tooLarge++;
+        return -1;
+    }
+
+    const uint64_t n = ++sequence;
+    const size_t stride = slotStrideFor(header->slotBytes);
+    unsigned char *at = base + sizeof(RingHeader) + stride * ((n - 1) % header->slots);
+    SlotHeader *slot = reinterpret_cast<SlotHeader *>(at);
+    unsigned char *pixels = at + sizeof(SlotHeader);
+
+    // odd while the slot is inconsistent, a reader that saw the old frame finds it changed
+    slot->seq.store(2 * n - 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot->rows = frame.rows;
+    slot->cols = frame.cols;
+    slot->type = frame.type();
+    slot->step = (int32_t)rowBytes;
+    slot->timestamp = timestamp;
+    if (frame.isContinuous())
+    {
+        memcpy(pixels, frame.data, rowBytes * frame.rows);
+    }
+    else
+    {
+        for (int i = 0; i < frame.rows; i++)
+        {
+            memcpy(pixels + rowBytes * i, frame.ptr(i), rowBytes);
+        }
+    }
+    slot->seq.store(2 * n, std::memory_order_release);
+    header->latest.store(n, std::memory_order_release);
+    return 0;
+}
+
+void FrameRingWriter::close()
+{
+    if (!base)
+    {
+        return;
+    }
+    reinterpret_cast<RingHeader *>(base)->closed.store(1, std::memory_order_release);
+    munmap(base, mapped);
+    shm_unlink(name.c_str());
+    base = NULL;
+    mapped = 0;
+}
+
+FrameRingReader::FrameRingReader() : base(NULL), mapped(0), slotCount(0), slotStride(0)
+{
+}
+
+FrameRingReader::~FrameRingReader()
+{
+    unmap();
+}
+
+void FrameRingReader::unmap()
+{
+    if (base)
+    {
+        munmap(const_cast<unsigned char *>(base), mapped);
+        base = NULL;
+        mapped = 0;
+    }
+}
+
+int FrameRingReader::open(const std::string &name, std::string *error)
+{
+    unmap();
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+    {
+        return fail(error, "shm_open " + name + ": " + strerror(errno));
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(RingHeader))
+    {
+        ::close(fd);
+        return fail(error, name + " is not a frame ring (too small)");
+    }
+    void *memory = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED)
+    {
+        return fail(error, "mmap " + name + ": " + strerror(errno));
+    }
+    base = static_cast<const unsigned char *>(memory);
+    mapped = info.st_size;
+
+    const RingHeader *header = reinterpret_cast<const RingHeader *>(base);
+    const uint32_t magic = header->magic;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (magic != ringMagic || header->version != ringVersion)
+    {
+        unmap();
+        return fail(error, name + " is not a frame ring of version " + std::to_string(ringVersion));
+    }
+    // the header comes from another process: check the sizes against the mapping before
+    // anything is multiplied, so a corrupt header cannot wrap the product around
+    const uint32_t slots = header->slots;
+    const uint64_t slotBytes = header->slotBytes;
+    const size_t available = mapped - sizeof(RingHeader);
+    if (slots < 1 || slots > (uint32_t)INT_MAX || slotBytes == 0 || slotBytes > available)
+    {
+        unmap();
+        return fail(error, name + " has an invalid slot count or size");
+    }
+    slotCount = (int)slots;
+    slotStride = slotStrideFor(slotBytes);
+    if (slotStride > available / slotCount)
+    {
+        unmap();
+        return fail(error, name + " is shorter than its header says");
+    }
+    return 0;
+}
+
+uint64_t FrameRingReader::latest() const
+{
+    return base ? reinterpret_cast<const RingHeader *>(base)->latest.load(std::memory_order_acquire) : 0;
+}
+
+bool FrameRingReader::isClosed() const
+{
+    return !base || reinterpret_cast<const RingHeader *>(base)->closed.load(std::memory_order_acquire) != 0;
+}
+
+int FrameRingReader::view(uint64_t sequence, cv::Mat &frame, FrameRingInfo &info) const
+{
+    if (!base || sequence == 0 || sequence > latest())
+    {
+        return -1;
+    }
+    const unsigned char *at = base + sizeof(RingHeader) + slotStride * ((sequence - 1) % slotCount);
+    const SlotHeader *slot = reinterpret_cast<const SlotHeader *>(at);
+    if (slot->seq.load(std::memory_order_acquire) != 2 * sequence)
+    {
+        return -1;
+    }
+    const int rows = slot->rows;
+    const int cols = slot->cols;
+    const int type = slot->type;
+    const size_t step = slot->step;
+    info.sequence = sequence;
+    info.timestamp = slot->timestamp;
+    // the header fields are only meaningful if the writer did not touch the slot meanwhile
+    if (!isCurrent(sequence))
+    {
+        return -1;
+    }
+    frame = cv::Mat(rows, cols, type, const_cast<unsigned char *>(at + sizeof(SlotHeader)), step);
+    return 0;
+}
+
+bool FrameRingReader::isCurrent(uint64_t sequence) const
+{
+    if (!base || sequence == 0)
+    {
+        return false;
+    }
+    const SlotHeader *slot =
+        reinterpret_cast<const SlotHeader *>(base + sizeof(RingHeader) + slotStride * ((sequence - 1) % slotCount));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot->seq.load(std::memory_order_relaxed) == 2 * sequence;
+}
@@ -0,0 +1,170 @@
+/**
+ * author: Harshit Kumar and Khushi Neema
+ * date: Oct 17, 2026
+ * purpose: Per-stage frame timing for the live viewer: rolling percentiles,
+ * an on-screen overlay and a summary on exit.
+ *
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include "frameStats.h"
+
+// session histograms: 0.05 ms buckets up to 500 ms, anything slower lands in the last one
+static const double bucketMs = 0.05;
+static const size_t bucketCount = 10000;
+
+// fps is measured over this many recently shown frames
+static const size_t fpsWindow = 60;
+
+FrameStats::FrameStats(size_t window, double budgetMs)
+    : window(std::max<size_t>(window, 1)), budgetMs(budgetMs)
+{
+}
+
+FrameStats::Stage &FrameStats::stage(const std::string &name)
+{
+    for (size_t i = 0; i < stages.size(); i++)
+    {
+        if (stages[i].name == name)
+        {
+            return stages[i];
+        }
+    }
+    Stage s;
+    s.name = name;
+    s.next = 0;
+    s.histogram.assign(bucketCount, 0);
+    s.count = 0;
+    s.total = 0;
+    s.max = 0;
+    stages.push_back(s);
+    return stages.back();
+}
+
+void FrameStats::record(const std::string &name, double ms)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    Stage &s = stage(name);
+
+    if (s.recent.size() < window)
+    {
+        s.recent.push_back(ms);
+    }
+    else
+    {
+        s.recent[s.next] = ms;
+    }
+    s.next = (s.next + 1) % window;
+
+    size_t bucket = std::min(bucketCount - 1, (size_t)(std::max(ms, 0.0) / bucketMs));
+    s.histogram[bucket]++;
+    s.count++;
+    s.total += ms;
+    s.max = std::max(s.max, ms);
+}
+
+void FrameStats::frameShown(double timestamp)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    shown.push_back(timestamp);
+    while (shown.size() > fpsWindow)
+    {
+        shown.pop_front();
+    }
+}
+
+double FrameStats::fps() const
+{
+    if (shown.size() < 2 || shown.back() <= shown.front())
+    {
+        return 0;
+    }
+    return (shown.size() - 1) / (shown.back() - shown.front());
+}
+
+void FrameStats::percentiles(std::vector<double> samples, double &p50, double &p95, double &p99)
+{
+    p50 = p95 = p99 = 0;
+    if (samples.empty())
+    {
+        return;
+    }
+    // nearest-rank percentiles of the window
+    std::sort(samples.begin(), samples.end());
+    size_t n = samples.size();
+    p50 = samples[std::min(n - 1, (size_t)(0.50 * n))];
+    p95 = samples[std::min(n - 1, (size_t)(0.95 * n))];
+    p99 = samples[std::min(n - 1, (size_t)(0.99 * n))];
+}
+
+double FrameStats::histogramPercentile(const Stage &s, double p)
+{
+    size_t rank = (size_t)(p * s.count);
+    size_t seen = 0;
+    for (size_t i = 0; i < bucketCount; i++)
+    {
+        seen += s.histogram[i];
+        if (seen > rank)
+        {
+            // upper edge of the bucket, but never more than was actually seen
+            return std::min((i + 1) * bucketMs, s.max);
+        }
+    }
+    return s.max;
+}
+
+void FrameStats::drawOverlay(cv::Mat &frame) const
+{
+    std::lock_guard<std::mutex> guard(lock);
+
+    const int lineHeight = 22;
+    const int width = 430;
+    const int height = lineHeight * (int)(stages.size() + 2) + 8;
+    cv::Rect box(std::max(0, frame.cols - width - 10), 10, std::min(width, frame.cols), std::min(height, frame.rows - 10));
+    if (box.width <= 0 || box.height <= 0)
+    {
+        return;
+    }
+
+    // darken the panel so the text stays readable on any effect
+    cv::Mat panel = frame(box);
+    panel.convertTo(panel, -1, 0.35);
+
+    char line[128];
+    int y = box.y + lineHeight;
+    snprintf(line, sizeof(line), "%.1f fps   (budget %.1f ms)", fps(), budgetMs);
+    cv::putText(frame, line, cv::Point(box.x + 8, y), cv::FONT_HERSHEY_SIMPLEX, 0.55, cv::Scalar(255, 255, 255), 1);
+    y += lineHeight;
+    cv::putText(frame, "stage            p50     p95     p99 ms", cv::Point(box.x + 8, y), cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(200, 200, 200), 1);
+
+    for (size_t i = 0; i < stages.size(); i++)
+    {
+        double p50, p95, p99;
+        percentiles(stages[i].recent, p50, p95, p99);
+        y += lineHeight;
+        snprintf(line, sizeof(line), "%-14s %7.2f %7.2f %7.2f", stages[i].name.c_str(), p50, p95, p99);
+        // red when the stage alone is over the frame budget
+        cv::Scalar color = p95 > budgetMs ? cv::Scalar(60, 60, 255) : cv::Scalar(120, 255, 120);
+        cv::putText(frame, line, cv::Point(box.x + 8, y), cv::FONT_HERSHEY_PLAIN, 1.1, color, 1);
+    }
+}
+
+void FrameStats::printSummary() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+
+    printf("\nFrame timing summary (ms)\n");
+    printf("%-14s %8s %8s %8s %8s %8s %8s\n", "stage", "count", "mean", "p50", "p95", "p99", "max");
+    for (size_t i = 0; i < stages.size(); i++)
+    {
+        const Stage &s = stages[i];
+        if (s.count == 0)
+        {
+            continue;
+        }
+        printf("%-14s %8zu %8.2f %8.2f %8.2f %8.2f %8.2f\n", s.name.c_str(), s.count, s.total / s.count,
+               histogramPercentile(s, 0.50), histogramPercentile(s, 0.95), histogramPercentile(s, 0.99), s.max);
+    }
+    printf("fps (last %zu frames): %.1f\n", shown.size(), fps());
+}
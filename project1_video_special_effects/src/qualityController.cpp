@@ -0,0 +1,135 @@
+/**
+ * author: Harshit Kumar and Khushi Neema
+ * date: Oct 17, 2026
+ * purpose: Lowers the quality of the live effects when they miss the frame deadline, and restores it.
+ *
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include "qualityController.h"
+
+// frames averaged for every decision, about a third of a second at 30 fps
+static const size_t windowFrames = 10;
+
+// a window whose mean is above this share of the budget is at risk of missing it
+static const double degradeShare = 0.85;
+
+// a higher step is only taken back when its predicted cost is below this share of the budget
+static const double restoreShare = 0.7;
+
+QualityController::QualityController(double budgetMs)
+    : budgetMs(budgetMs), level(0), leftAt(0), switches(0)
+{
+}
+
+void QualityController::reset(FilterGraph &graph)
+{
+    // each step keeps the savings of the one before and adds one more
+    ladder.clear();
+    Step step;
+    step.ratio = 0;
+    ladder.push_back(step);
+    if (graph.hasCheaperStages())
+    {
+        step.quality.cheapStages = true;
+        ladder.push_back(step);
+    }
+    if (graph.usesFaces())
+    {
+        step.quality.faceEvery = 2;
+        ladder.push_back(step);
+    }
+    step.quality.scale = 2;
+    ladder.push_back(step);
+    step.quality.scale = 4;
+    ladder.push_back(step);
+
+    if (level != 0)
+    {
+        printf("Quality: %s (effect changed)\n", ladder[0].quality.describe().c_str());
+    }
+    level = 0;
+    leftAt = 0;
+    window.clear();
+    graph.setQuality(ladder[0].quality);
+}
+
+void QualityController::moveTo(FilterGraph &graph, size_t next, double mean)
+{
+    printf("Quality: %s -> %s (effect %.1f ms per frame, budget %.1f ms)\n", ladder[level].quality.describe().c_str(),
+           ladder[next].quality.describe().c_str(), mean, budgetMs);
+    leftAt = next > level ? mean : 0;
+    level = next;
+    window.clear();
+    switches++;
+    graph.setQuality(ladder[level].quality);
+}
+
+bool QualityController::frameDone(FilterGraph &graph, double ms)
+{
+    if (ladder.empty())
+    {
+        reset(graph);
+    }
+
+    // looked up by value, describing it here would allocate on every frame
+    size_t i = 0;
+    while (i < framesAt.size() && !(framesAt[i].first == ladder[level].quality))
+    {
+        i++;
+    }
+    if (i == framesAt.size())
+    {
+        framesAt.push_back(std::make_pair(ladder[level].quality, (size_t)0));
+    }
+    framesAt[i].second++;
+
+    window.push_back(ms);
+    if (window.size() < windowFrames)
+    {
+        return false;
+    }
+    double mean = 0;
+    for (size_t k = 0; k < window.size(); k++)
+    {
+        mean += window[k];
+    }
+    mean /= window.size();
+    window.clear();
+
+    // right after a step down the scene is the same as in the window that caused it,
+    // so the two windows tell what the step saves
+    Step &step = ladder[level];
+    if (leftAt > 0)
+    {
+        step.ratio = std::min(mean / leftAt, 1.0);
+        leftAt = 0;
+    }
+
+    if (mean > degradeShare * budgetMs && level + 1 < ladder.size())
+    {
+        moveTo(graph, level + 1, mean);
+        return true;
+    }
+    if (level > 0 && step.ratio > 0 && mean / step.ratio < restoreShare * budgetMs)
+    {
+        moveTo(graph, level - 1, mean);
+        return true;
+    }
+    return false;
+}
+
+void QualityController::printSummary() const
+{
+    if (framesAt.size() <= 1 && switches == 0)
+    {
+        return;
+    }
+    printf("Adaptive quality: %zu switches, frames at", switches);
+    for (size_t i = 0; i < framesAt.size(); i++)
+    {
+        printf("%s %s: %zu", i > 0 ? "," : "", framesAt[i].first.describe().c_str(), framesAt[i].second);
+    }
+    printf("\n");
+}
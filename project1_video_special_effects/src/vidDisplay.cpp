@@ -5,305 +5,762 @@
  *
 */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 #include "vidDisplay.h"
 #include "filter.h"
-#include "faceDetect.h"
+#include "boundedQueue.h"
+#include "videoRecorder.h"
+#include "frameRing.h"
+#include "frameStats.h"
+#include "frameSource.h"
+#include "filterGraph.h"
+#include "qualityController.h"
+#include "allocCounter.h"
 
 using namespace std;
 
-int displayVideo(int videoDeviceIndex) {
-    // Open the video device
-    cv::VideoCapture capdev(videoDeviceIndex);
-    if (!capdev.isOpened()) {
-        printf("Unable to open video device\n");
+// The effect chain picked by the keys, handed from the display thread to the processing thread
+struct EffectSelection {
+    std::mutex lock;
+    std::string spec;
+    std::atomic<int> version;  // bumped on every change
+};
+
+// An effect key and the filter chain it selects
+struct EffectKey {
+    char key;
+    const char *spec;
+    const char *message;
+};
+
+static const EffectKey effectKeys[] = {
+    {'o', "original", "Converting to original colors."},
+    {'g', "cvgrey", "Converting to opencv greyscale."},
+    {'h', "greyscale", "Converting to custom greyscale."},
+    {'t', "sepia", "Converting to custom sepia."},
+    {'b', "blurslow", "Converting to custom blur."},
+    {'B', "blur", "Converting to custom (faster) blur."},
+    {'x', "sobelx", "Converting to sobelX filter."},
+    {'y', "sobely", "Converting to sobelY filter."},
+    {'l', "blur>quantize:10", "Blur and Quantizing Image"},
+    {'m', "magnitude", "Generating Gradient Magnitude Image"},
+    {'f', "faces", "Using face detect."},
+    {'c', "colorface", "Make face colorful."},
+    {'a', "blurbackground", "Make background blur."},
+    {'n', "negative", "Make negative image."},
+    {'e', "emboss", "Make embossing effect."},
+    {'z', "comic", "Make comic book effect."},
+    {'d', "motion", "Highlighting motion."},
+};
+
+// A frame travelling through the pipeline
+struct PipelineFrame {
+    cv::Mat frame;     // the image, processed in place by the effects stage
+    cv::Mat raw;       // unprocessed copy, only kept while the raw stream is recorded
+    double timestamp;  // capture time in seconds
+};
+
+// Seconds on a monotonic clock, used to timestamp captured frames
+static double secondsNow() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// How long an idle stage sleeps before polling its input queue again
+static const std::chrono::milliseconds idlePoll(1);
+
+// Time the effects may take per frame: PROJECT1_FRAME_BUDGET_MS, or 30 fps when unset
+static double frameBudgetMs() {
+    const char *env = getenv("PROJECT1_FRAME_BUDGET_MS");
+    double ms = env ? atof(env) : 0;
+    return ms > 0 ? ms : 1000.0 / 30.0;
+}
+
+/*
+  Capture stage: reads frames from the source as fast as it delivers them and
+  queues them, dropping the oldest queued frame when processing falls behind.
+ */
+static void captureLoop(FrameSource &source, BoundedQueue<PipelineFrame> &captured, FrameStats &stats,
+                        std::atomic<bool> &stop, std::atomic<bool> &captureDone) {
+    while (!stop) {
+        // a fresh Mat every time, queued frames must not share a buffer
+        PipelineFrame item;
+        bool read;
+        {
+            StageTimer timer(&stats, "capture");
+            read = source.read(item.frame); // Get a new frame from the source, treat as a stream
+        }
+        item.timestamp = secondsNow();
+        if (!read) {
+            printf("End of input\n");
+            break;
+        }
+        captured.pushDropOldest(item);
+    }
+    captureDone = true;
+}
+
+/*
+  Processing stage: applies the currently selected effect chain to the newest
+  frames and queues the results for display, again dropping the oldest on overflow.
+  While adaptive is set the chain's quality is lowered when it misses the frame budget.
+ */
+static void processLoop(BoundedQueue<PipelineFrame> &captured, BoundedQueue<PipelineFrame> &processed,
+                        FrameStats &stats, EffectSelection &selection, std::atomic<bool> &keepRaw,
+                        std::atomic<bool> &adaptive, double budgetMs, std::atomic<bool> &stop,
+                        std::atomic<bool> &captureDone, std::atomic<bool> &processDone) {
+    // the graph and its buffers live on this thread and are only replanned when the keys change it
+    FilterGraph graph;
+    graph.setStats(&stats);
+    QualityController controller(budgetMs);
+    bool adapting = adaptive;
+    int version = -1;
+    std::string label;
+    cv::Scalar labelColor;
+    // debug builds with PROJECT1_COUNT_ALLOCS check that the graph stops allocating once planned
+    size_t frames = 0, allocatingFrames = 0, allocations = 0;
+    PipelineFrame item;
+    while (!stop) {
+        if (selection.version != version) {
+            std::lock_guard<std::mutex> guard(selection.lock);
+            version = selection.version;
+            graph.configure(selection.spec);
+            label = graph.label();
+            labelColor = graph.labelColor();
+            controller.reset(graph);
+        }
+        if (adaptive != adapting) {
+            // back to full quality either way, the controller starts over when turned on
+            adapting = adaptive;
+            controller.reset(graph);
+        }
+
+        // read the flag before popping so the last captured frame is never missed
+        bool finished = captureDone;
+        if (!captured.tryPop(item)) {
+            if (finished) {
+                break;
+            }
+            std::this_thread::sleep_for(idlePoll);
+            continue;
+        }
+        if (keepRaw) {
+            item.raw = item.frame.clone();
+        }
+        cv::putText(item.frame, label, cv::Point(30, 50), cv::FONT_HERSHEY_DUPLEX, 1.5, labelColor, 3);
+        size_t before = threadAllocationCount();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        {
+            StageTimer timer(&stats, "effect");
+            graph.apply(item.frame);
+        }
+        size_t allocated = threadAllocationCount() - before;
+        if (adapting) {
+            controller.frameDone(graph, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+        frames++;
+        allocations += allocated;
+        allocatingFrames += allocated > 0;
+        processed.pushDropOldest(item);
+        item = PipelineFrame();
+    }
+    if (graph.faceTracker().detections() > 0) {
+        graph.faceTracker().printSummary();
+    }
+    controller.printSummary();
+    if (allocationCountEnabled()) {
+        printf("Effect heap allocations: %zu in %zu frames, %zu frames allocated\n", allocations, frames, allocatingFrames);
+    }
+    processDone = true;
+}
+
+/*
+  Publishes a new effect chain to the processing thread after checking that it parses.
+ */
+static bool selectEffect(EffectSelection &selection, const std::string &spec) {
+    FilterGraph check;
+    std::string error;
+    if (check.configure(spec, &error) != 0) {
+        cout << "Invalid effect chain: " << error << endl;
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> guard(selection.lock);
+        selection.spec = spec;
+    }
+    selection.version++;
+    cout << "Effect chain: " << check.plan() << endl;
+    return true;
+}
+
+int displayVideo(const FrameSourceOptions &sourceOptions, const std::string &effectChain,
+                 const std::string &publishName) {
+    // Open the camera, file, image directory or pattern
+    std::unique_ptr<FrameSource> source;
+    std::string error;
+    if (openFrameSource(sourceOptions, source, &error) != 0) {
+        printf("Unable to open the source: %s\n", error.c_str());
         return -1;
     }
 
     // Get some properties of the image
-    cv::Size refS((int)capdev.get(cv::CAP_PROP_FRAME_WIDTH),
-        (int)capdev.get(cv::CAP_PROP_FRAME_HEIGHT));
-    printf("Expected size: %d %d\n", refS.width, refS.height);
+    cv::Size refS = source->size();
+    printf("Source: %s, expected size: %d %d\n", source->describe().c_str(), refS.width, refS.height);
 
     cv::namedWindow("Video", 1); // Identifies a window
-    cv::Mat frame;
-    cv::Mat filter = frame;
-    cv::Mat grey;
-    std::vector<cv::Rect> faces;
-    cv::Rect last(0, 0, 0, 0);
-    cv::VideoWriter video;
-    bool isVideoWriterInitialized = false;
+    // recorders are created on the first 'v' / 'V' and paused by '0'
+    std::unique_ptr<VideoRecorder> video;
+    std::unique_ptr<VideoRecorder> rawVideo;
     bool isSavingVideo = false;
+    const int fourcc = cv::VideoWriter::fourcc('M', 'J', 'P', 'G');
+    // shared-memory sink, created at the first frame once its size is known
+    FrameRingWriter ring;
+    bool publishing = !publishName.empty();
+    bool ringFits = true;  // whether the last frame fit a slot, the changes are reported
 
-    char lastKeypress = '\0';  // Initialize the last keypress variable
+    // effect keys replace the chain, or append to it while stacking ('+') is on
+    EffectSelection selection;
+    selection.version = 0;
+    std::string chain;
+    bool stacking = false;
+    if (!effectChain.empty() && selectEffect(selection, effectChain)) {
+        chain = effectChain;
+    }
 
-    for (;;) {
-        capdev >> frame; // Get a new frame from the camera, treat as a stream
-        if (frame.empty()) {
-            printf("Frame is empty\n");
-            break;
-        }
+    // capture -> process -> display/encode, each stage on its own thread; the
+    // queues are short so a slow stage drops stale frames instead of adding latency
+    BoundedQueue<PipelineFrame> captured(2);
+    BoundedQueue<PipelineFrame> processed(2);
+    std::atomic<bool> isSavingRaw(false);
+    std::atomic<bool> stop(false);
+    std::atomic<bool> captureDone(false);
+    std::atomic<bool> processDone(false);
+
+    // per-stage timing, shown by 'i' and summarised on exit
+    const double budgetMs = frameBudgetMs();
+    FrameStats stats(120, budgetMs);
+    bool showStats = false;
+    // effects drop to lower quality when they miss the budget, 'u' turns this off and on
+    std::atomic<bool> adaptive(true);
+
+    std::thread captureThread(captureLoop, std::ref(*source), std::ref(captured), std::ref(stats),
+                              std::ref(stop), std::ref(captureDone));
+    std::thread processThread(processLoop, std::ref(captured), std::ref(processed), std::ref(stats), std::ref(selection),
+                              std::ref(isSavingRaw), std::ref(adaptive), budgetMs, std::ref(stop), std::ref(captureDone),
+                              std::ref(processDone));
 
-        if (!isVideoWriterInitialized) {
-            video.open("out.avi", cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), 10, cv::Size(frame.cols, frame.rows));
-            isVideoWriterInitialized = true;
-        }
-
-        // Check the last keypress and modify the image accordingly
-        if (lastKeypress == 'g') {
-            cv::putText(frame, "OpenCV Greyscale", cv::Point(30, 50), cv::FONT_HERSHEY_DUPLEX, 1.5, cv::Scalar(0, 0, 255), 3);
-            cv::cvtColor(frame, frame, cv::COLOR_BGR2GRAY);
-        }
-        else if (lastKeypress == 'h') {
-            // Use the custom greyscale function
-            cv::putText(frame, "Custom Greyscale", cv::Point(30, 50), cv::FONT_HERSHEY_DUPLEX, 1.5, cv::Scalar(0, 0, 255), 3);
-            greyscale(frame, frame);
-        }
-        else if (lastKeypress == 't') {
-            // Use the custom sepia function
-            cv::putText(frame, "Custom Sepia", cv::Point(30, 50), cv::FONT_HERSHEY_DUPLEX, 1.5, cv::Scalar(0, 0, 255), 3);
-            sepia(frame, frame);
-        }
-        else if (lastKeypress == 'b') {
-            // Use the custom blur function
-            cv::putText(frame, "Custom Blur", cv::Point(30, 50), cv::FONT_HERSHEY_DUPLEX, 1.5, cv::Scalar(0, 0, 255), 3);
-            blur5x5_1(frame, frame);
-        }
-        else if (lastKeypress == 'B') {
-            // Use the custom (faster) blur function
-            cv::putText(frame, "Custom Blur (faster)", cv::Point(30, 50), cv::FONT_HERSHEY_DUPLEX, 1.5, cv::Scalar(0, 0, 255), 3);
-            blur5x5_2(frame, filter);
-            cv::convertScaleAbs(filter, frame);
-        }
-        else if (lastKeypress == 'x') {
-            cv::putText(frame, "SobelX", cv::Point(30, 50), cv::FONT_HERSHEY_DUPLEX, 1.5, cv::Scalar(0, 0, 255), 3);
-            sobelX3x3(frame, filter);
-            cv::convertScaleAbs(filter, frame);
-            // cv::imshow("SobelX", filter);
-        }
-        else if (lastKeypress == 'y') {
-            cv::putText(frame, "SobelY", cv::Point(30, 50), cv::FONT_HERSHEY_DUPLEX, 1.5, cv::Scalar(0, 0, 255), 3);
-            sobelY3x3(frame, filter);
-            cv::convertScaleAbs(filter, frame);
-            // cv::imshow("SobelY", filter);
-        }
-        else if (lastKeypress == 'm') {
-            cv::putText(frame, "Gradient Image from Sobel X and Y", cv::Point(30, 50), cv::FONT_HERSHEY_DUPLEX, 1.5, cv::Scalar(0, 255, 0), 3);
-            cv::Mat grad_x, grad_y;
-            sobelX3x3(frame, grad_x);
-            sobelY3x3(frame, grad_y);
-            //Calling Gradient Function 
-            magnitude(grad_x, grad_y, filter);
-            cv::convertScaleAbs(filter, frame);
-        }
-        else if (lastKeypress == 'l') {
-            cv::putText(frame, "Blur and quantize", cv::Point(30, 50), cv::FONT_HERSHEY_DUPLEX, 1.5, cv::Scalar(0, 255, 0), 3);
-            blurQuantize(frame, filter, 10);
-            cv::convertScaleAbs(filter, frame);
-        }
-        else if (lastKeypress == 'f') {
-            cv::putText(frame, "Face Detect", cv::Point(30, 50), cv::FONT_HERSHEY_DUPLEX, 1.5, cv::Scalar(0, 0, 255), 3);
-            // use facedetect
-            // convert the image to greyscale
-            cv::cvtColor(frame, grey, cv::COLOR_BGR2GRAY, 0);
-            // detect faces
-            detectFaces(grey, faces);
-            // draw boxes around the faces
-            drawBoxes(frame, faces);
-            // add a little smoothing by averaging the last two detections
-            if (faces.size() > 0) {
-                last.x = (faces[0].x + last.x) / 2;
-                last.y = (faces[0].y + last.y) / 2;
-                last.width = (faces[0].width + last.width) / 2;
-                last.height = (faces[0].height + last.height) / 2;
+    // display/encode stage stays on this thread, HighGUI wants the main thread
+    cv::Mat shown;
+    for (;;) {
+        PipelineFrame item;
+        bool finished = processDone;
+        if (processed.tryPop(item)) {
+            // hand frames to the encoder threads, this never blocks the preview
+            if (isSavingVideo) {
+                video->write(item.frame, item.timestamp);
             }
-        }
-        else if (lastKeypress == 'c') {
-            cv::putText(frame, "Colorful Face", cv::Point(30, 50), cv::FONT_HERSHEY_DUPLEX, 1.5, cv::Scalar(0, 0, 255), 3);
-            // Make the face colorful, while the rest of the image is greyscale.
-            // use facedetect
-            // convert the image to greyscale
-            cv::cvtColor(frame, grey, cv::COLOR_BGR2GRAY, 0);
-            // detect faces
-            detectFaces(grey, faces);
-            // draw boxes around the faces
-            drawBoxes(frame, faces);
-            // add a little smoothing by averaging the last two detections
-            if (faces.size() > 0) {
-                last.x = (faces[0].x + last.x) / 2;
-                last.y = (faces[0].y + last.y) / 2;
-                last.width = (faces[0].width + last.width) / 2;
-                last.height = (faces[0].height + last.height) / 2;
+            if (isSavingRaw && !item.raw.empty()) {
+                rawVideo->write(item.raw, item.timestamp);
             }
-            // Create a grayscale version of the frame
-            cv::Mat gray;
-            cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
-            cv::cvtColor(gray, gray, cv::COLOR_GRAY2BGR);
-
-            cv::Mat mask = cv::Mat::zeros(frame.size(), CV_8U);
-            for (const auto& face : faces) {
-                // Include faces in the mask
-                cv::rectangle(mask, face, cv::Scalar(255), -1);
+            if (publishing) {
+                if (!ring.isOpen()) {
+                    // room for a colour frame of this size, whatever the chain outputs later
+                    std::string error;
+                    if (ring.open(publishName, item.frame.total() * 3, frameRingDefaultSlots, &error) != 0) {
+                        printf("Unable to publish frames: %s\n", error.c_str());
+                        publishing = false;
+                    }
+                    else {
+                        printf("Publishing frames to %s\n", publishName.c_str());
+                    }
+                }
+                if (publishing) {
+                    StageTimer timer(&stats, "publish");
+                    // the slots keep their size, so a chain with larger frames is left out until it shrinks again
+                    const bool fits = ring.publish(item.frame, item.timestamp) == 0;
+                    if (fits != ringFits) {
+                        if (fits) {
+                            printf("Publishing to %s again\n", publishName.c_str());
+                        }
+                        else {
+                            printf("%dx%d frames (%d channels) do not fit the slots of %s, not publishing them\n",
+                                   item.frame.cols, item.frame.rows, item.frame.channels(), publishName.c_str());
+                        }
+                        ringFits = fits;
+                    }
+                }
             }
-            cv::Mat mask3;
-            cv::cvtColor(mask, mask3, cv::COLOR_GRAY2BGR);
-            frame = (frame & mask3) + (gray & ~mask3);
-        }
-        else if (lastKeypress == 'a') {
-            cv::putText(frame, "Blur background", cv::Point(30, 50), cv::FONT_HERSHEY_DUPLEX, 1.5, cv::Scalar(0, 0, 255), 3);
-            // Make the face colorful, while the rest of the image is greyscale.
-            // use facedetect
-            // convert the image to greyscale
-            cv::cvtColor(frame, grey, cv::COLOR_BGR2GRAY, 0);
-            // detect faces
-            detectFaces(grey, faces);
-            // draw boxes around the faces
-            drawBoxes(frame, faces);
-            // add a little smoothing by averaging the last two detections
-            if (faces.size() > 0) {
-                last.x = (faces[0].x + last.x) / 2;
-                last.y = (faces[0].y + last.y) / 2;
-                last.width = (faces[0].width + last.width) / 2;
-                last.height = (faces[0].height + last.height) / 2;
+
+            // the recorders still read item.frame on their threads, so the overlay
+            // goes on a copy that is only shown and never ends up in the files
+            cv::Mat display = item.frame;
+            if (showStats) {
+                display = item.frame.clone();
+                stats.drawOverlay(display);
             }
-            // Create a mask with the same size as the frame, filled with white color
-            cv::Mat mask = cv::Mat::ones(frame.size(), CV_8U) * 255;
-            // For each detected face
-            for (const auto& face : faces) {
-                // Set the region corresponding to the face to black in the mask
-                mask(face) = 0;
+            {
+                StageTimer timer(&stats, "display");
+                cv::imshow("Video", display);
             }
-            // Blur the entire image
-            cv::Mat blurred;
-            // cv::blur(frame, blurred, cv::Size(15, 15));
-            blur5x5_2(frame, blurred);
-            // Combine the blurred and original images using the mask
-            blurred.copyTo(frame, mask);
-        }
-        else if (lastKeypress == 'n') {
-            cv::putText(frame, "Negative Image", cv::Point(30, 50), cv::FONT_HERSHEY_DUPLEX, 1.5, cv::Scalar(0, 0, 255), 3);
-            // negative image
-            frame = 255 - frame;
-        }
-        else if (lastKeypress == 'e') {
-            cv::putText(frame, "Embossing Effect", cv::Point(30, 50), cv::FONT_HERSHEY_DUPLEX, 1.5, cv::Scalar(0, 255, 0), 3);
-            // Make an embossing effect
-            cv::Mat grad_x, grad_y;
-            sobelX3x3(frame, grad_x);
-            sobelY3x3(frame, grad_y);
-            cv::convertScaleAbs(grad_x, grad_x);
-            cv::convertScaleAbs(grad_y, grad_y);
-            frame = grad_x * 0.7071 + grad_y * 0.7071;
-        }
-        
-        else if (lastKeypress == 'z') {
-            // comic book effect
-            cv::putText(frame, "Comic Book Effect", cv::Point(30, 50), cv::FONT_HERSHEY_DUPLEX, 1.5, cv::Scalar(255, 0, 255), 3);
-            comicBookEffect(frame, frame);
-        }
-        else if (lastKeypress == 'v') {
-            cv::putText(frame, "Video Saving Started", cv::Point(30, 50), cv::FONT_HERSHEY_DUPLEX, 1.5, cv::Scalar(255, 0, 0), 3);
-            // save short video sequences with the special effects
-            // save the current frame to the video
-            isSavingVideo = true;
-        }
-        else if (lastKeypress == '0') {
-            cv::putText(frame, "Video Saving Stopped", cv::Point(30, 50), cv::FONT_HERSHEY_DUPLEX, 1.5, cv::Scalar(255, 0, 0), 3);
-            // stop video saving
-            isSavingVideo = false;
-        }
-        else {
-            cv::putText(frame, "Original Video", cv::Point(30, 50), cv::FONT_HERSHEY_DUPLEX, 1.5, cv::Scalar(255, 0, 0), 3);
+            shown = item.frame;
+            double now = secondsNow();
+            stats.record("latency", (now - item.timestamp) * 1000.0);
+            stats.frameShown(now);
         }
-
-        if (isSavingVideo) {
-            video.write(frame);
+        else if (finished) {
+            break;
         }
 
-        cv::imshow("Video", frame);
-
         // check waiting keystroke
-        char key = cv::waitKey(10);
+        char key = cv::waitKey(1);
         if (key == 'q') {
             break;
         }
         else if (key == 's') {
             cout << key << " pressed: Saving frame to captured_frame.png." << endl;
-            cv::imwrite("captured_frame.png", frame);
+            cv::imwrite("captured_frame.png", shown);
         }
-        else if (key == 'o') {
-            lastKeypress = 'o';  // update last keypress variable
-            cout << lastKeypress << " pressed: Converting to original colors." << endl;
+        else if (key == 'i') {
+            // toggle the frame timing overlay, the effect stays as it is
+            showStats = !showStats;
+            cout << key << " pressed: " << (showStats ? "Showing" : "Hiding") << " frame timing." << endl;
         }
-        else if (key == 'g') {
-            lastKeypress = 'g';
-            cout << lastKeypress << " pressed: Converting to opencv greyscale." << endl;
+        else if (key == 'u') {
+            adaptive = !adaptive;
+            cout << key << " pressed: Adaptive quality " << (adaptive ? "on" : "off (always full quality)") << "." << endl;
         }
-        else if (key == 'h') {
-            lastKeypress = 'h';
-            cout << lastKeypress << " pressed: Converting to custom greyscale." << endl;
+        else if (key == '+') {
+            stacking = !stacking;
+            cout << key << " pressed: " << (stacking ? "Stacking effects." : "Effects replace each other.") << endl;
         }
-        else if (key == 't') {
-            lastKeypress = 't';
-            cout << lastKeypress << " pressed: Converting to custom sepia." << endl;
+        else if (key == 'v') {
+            if (!video) {
+                video.reset(new VideoRecorder("out.avi", fourcc));
+                video->setStats(&stats, "encode");
+            }
+            isSavingVideo = true;
+            cout << key << " pressed: Video saving started." << endl;
         }
-        else if (key == 'b') {
-            lastKeypress = 'b';
-            cout << lastKeypress << " pressed: Converting to custom blur." << endl;
+        else if (key == 'V') {
+            if (!video) {
+                video.reset(new VideoRecorder("out.avi", fourcc));
+                video->setStats(&stats, "encode");
+            }
+            if (!rawVideo) {
+                rawVideo.reset(new VideoRecorder("out_raw.avi", fourcc));
+                rawVideo->setStats(&stats, "encode raw");
+            }
+            isSavingVideo = true;
+            isSavingRaw = true;
+            cout << key << " pressed: Video saving started (raw + effect)." << endl;
         }
-        else if (key == 'B') {
-            lastKeypress = 'B';
-            cout << lastKeypress << " pressed: Converting to custom (faster) blur." << endl;
+        else if (key == '0') {
+            if (isSavingVideo) {
+                video->pause();
+            }
+            if (isSavingRaw) {
+                rawVideo->pause();
+            }
+            isSavingVideo = false;
+            isSavingRaw = false;
+            cout << key << " pressed: Video saving stopped." << endl;
         }
-        else if (key == 'x') {
-            lastKeypress = 'x';
-            cout << lastKeypress << "pressed : Converting to sobelX filter." << endl;
+        else {
+            for (size_t i = 0; i < sizeof(effectKeys) / sizeof(effectKeys[0]); i++) {
+                if (key != effectKeys[i].key) {
+                    continue;
+                }
+                cout << key << " pressed: " << effectKeys[i].message << endl;
+                std::string next = effectKeys[i].spec;
+                if (stacking && key != 'o' && !chain.empty()) {
+                    next = chain + ">" + next;
+                }
+                if (selectEffect(selection, next)) {
+                    chain = next;
+                }
+                break;
+            }
         }
-        else if (key == 'y') {
-            lastKeypress = 'y';
-            cout << lastKeypress << "pressed : Converting to sobelY filter." << endl;
+    }
+
+    stop = true;
+    captureThread.join();
+    processThread.join();
+
+    printf("Dropped frames: %zu before processing, %zu before display\n", captured.dropped(), processed.dropped());
+
+    // flush the encoders and report what reached the files
+    if (video) {
+        video->stop();
+        printf("out.avi: %zu frames written (%zu repeated), %zu dropped, %zu skipped, %.2f fps\n",
+               video->framesWritten(), video->framesRepeated(), video->framesDropped(), video->framesSkipped(),
+               video->fps());
+    }
+    if (rawVideo) {
+        rawVideo->stop();
+        printf("out_raw.avi: %zu frames written (%zu repeated), %zu dropped, %zu skipped, %.2f fps\n",
+               rawVideo->framesWritten(), rawVideo->framesRepeated(), rawVideo->framesDropped(),
+               rawVideo->framesSkipped(), rawVideo->fps());
+    }
+
+    if (ring.isOpen()) {
+        printf("%s: %llu frames published, %zu too large for the ring\n", publishName.c_str(),
+               (unsigned long long)ring.published(), ring.skipped());
+        ring.close();
+    }
+
+    stats.printSummary();
+
+    return 0;
+}
+
+// Widest mosaic shown, tiles are scaled down to fit
+static const int mosaicWidth = 1920;
+
+// One source of the multi-camera viewer: its capture thread, effect graph and timing
+struct CameraPipeline {
+    CameraPipeline() : captured(2), processed(2), busy(false), captureDone(false), version(-1), frames(0) {}
+
+    std::unique_ptr<FrameSource> source;
+    std::unique_ptr<FrameStats> stats;
+    BoundedQueue<PipelineFrame> captured;
+    BoundedQueue<PipelineFrame> processed;  // the display keeps only the newest
+    std::atomic<bool> busy;                 // a worker owns the graph and the frame being processed
+    std::atomic<bool> captureDone;
+    std::thread capture;
+
+    // worker state, handed from worker to worker through busy
+    FilterGraph graph;
+    std::unique_ptr<QualityController> controller;
+    int version;
+    std::string label;
+    cv::Scalar labelColor;
+    size_t frames;
+
+    // display state
+    cv::Mat shown;
+    std::unique_ptr<VideoRecorder> video;
+};
+
+/*
+  Worker of the shared pool: claims the cameras round robin, one frame at a time, so
+  every camera gets its turn however fast the others deliver. A camera is only ever
+  processed by one worker at once, which keeps its graph (and motion or face state) in
+  frame order.
+ */
+static void cameraWorker(std::vector<std::unique_ptr<CameraPipeline> > &cameras, std::atomic<size_t> &cursor,
+                         EffectSelection &selection, std::atomic<bool> &adaptive, std::atomic<bool> &stop,
+                         std::atomic<int> &active) {
+    const size_t n = cameras.size();
+    PipelineFrame item;
+    while (!stop) {
+        CameraPipeline *cam = NULL;
+        size_t start = cursor.load();
+        bool allDone = true;
+        for (size_t k = 0; k < n && !cam; k++) {
+            const size_t c = (start + k) % n;
+            CameraPipeline &candidate = *cameras[c];
+            // read the flag before popping so the last captured frame is never missed
+            bool finished = candidate.captureDone;
+            if (candidate.busy.exchange(true)) {
+                allDone = false;
+                continue;
+            }
+            if (candidate.captured.tryPop(item)) {
+                cam = &candidate;
+                cursor = c + 1;
+            }
+            else {
+                candidate.busy = false;
+                allDone = allDone && finished;
+            }
         }
-        else if (key == 'l') {
-            lastKeypress = 'l';
-            cout << lastKeypress << "pressed : Blur and Quantizing Image" << endl;
+        if (!cam) {
+            if (allDone) {
+                break;
+            }
+            std::this_thread::sleep_for(idlePoll);
+            continue;
         }
-        else if (key == 'm') {
-            lastKeypress = 'm';
-            cout << lastKeypress << "pressed : Generating Gradient Magnitude Image" << endl;
+
+        if (selection.version != cam->version) {
+            std::lock_guard<std::mutex> guard(selection.lock);
+            cam->version = selection.version;
+            cam->graph.configure(selection.spec);
+            cam->label = cam->graph.label();
+            cam->labelColor = cam->graph.labelColor();
+            cam->controller->reset(cam->graph);
+        }
+        cv::putText(item.frame, cam->label, cv::Point(30, 50), cv::FONT_HERSHEY_DUPLEX, 1.5, cam->labelColor, 3);
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        {
+            StageTimer timer(cam->stats.get(), "effect");
+            cam->graph.apply(item.frame);
+        }
+        if (adaptive) {
+            cam->controller->frameDone(cam->graph, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count());
+        }
+        cam->frames++;
+        cam->processed.pushDropOldest(item);
+        item = PipelineFrame();
+        cam->busy = false;
+    }
+    active--;
+}
+
+// Tiles of the mosaic: as square a grid as fits the cameras, each tile the shape of the first camera
+static cv::Size mosaicGrid(size_t cameras) {
+    int cols = 1;
+    while ((size_t)(cols * cols) < cameras) {
+        cols++;
+    }
+    return cv::Size(cols, (int)((cameras + cols - 1) / cols));
+}
+
+// Scales frame into its tile of the mosaic, greyscale frames are shown in colour
+static void drawTile(cv::Mat &mosaic, const cv::Rect &tile, const cv::Mat &frame) {
+    cv::Mat view = mosaic(tile);
+    if (frame.channels() == 1) {
+        cv::Mat colour;
+        cv::cvtColor(frame, colour, cv::COLOR_GRAY2BGR);
+        cv::resize(colour, view, tile.size(), 0, 0, cv::INTER_AREA);
+    }
+    else {
+        cv::resize(frame, view, tile.size(), 0, 0, cv::INTER_AREA);
+    }
+}
+
+int displayCameras(const std::vector<FrameSourceOptions> &sourceOptions, const std::string &effectChain,
+                   bool mosaic, int workers) {
+    const double budgetMs = frameBudgetMs();
+    std::vector<std::unique_ptr<CameraPipeline> > cameras;
+    for (size_t i = 0; i < sourceOptions.size(); i++) {
+        std::unique_ptr<CameraPipeline> cam(new CameraPipeline);
+        std::string error;
+        if (openFrameSource(sourceOptions[i], cam->source, &error) != 0) {
+            printf("Unable to open source %zu: %s\n", i, error.c_str());
+            return -1;
+        }
+        printf("Source %zu: %s\n", i, cam->source->describe().c_str());
+        cam->stats.reset(new FrameStats(120, budgetMs));
+        cam->graph.setStats(cam->stats.get());
+        cam->controller.reset(new QualityController(budgetMs));
+        cameras.push_back(std::move(cam));
+    }
+
+    // one frame per camera is processed at a time, more workers than cameras would idle;
+    // the cores left over split each frame into row bands
+    const int cores = std::max(1, (int)std::thread::hardware_concurrency());
+    if (workers <= 0) {
+        workers = cores;
+    }
+    workers = std::min(workers, (int)cameras.size());
+    const int filterThreads = getFilterThreads();
+    setFilterThreads(std::max(1, cores / workers));
+    printf("%zu sources on %d workers\n", cameras.size(), workers);
+
+    EffectSelection selection;
+    selection.version = 0;
+    std::string chain;
+    bool stacking = false;
+    if (!effectChain.empty() && selectEffect(selection, effectChain)) {
+        chain = effectChain;
+    }
+
+    std::atomic<bool> stop(false);
+    std::atomic<bool> adaptive(true);
+    std::atomic<size_t> cursor(0);
+    std::atomic<int> active(workers);
+    for (size_t i = 0; i < cameras.size(); i++) {
+        CameraPipeline &cam = *cameras[i];
+        cam.capture = std::thread(captureLoop, std::ref(*cam.source), std::ref(cam.captured), std::ref(*cam.stats),
+                                  std::ref(stop), std::ref(cam.captureDone));
+    }
+    std::vector<std::thread> pool;
+    for (int w = 0; w < workers; w++) {
+        pool.push_back(std::thread(cameraWorker, std::ref(cameras), std::ref(cursor), std::ref(selection),
+                                   std::ref(adaptive), std::ref(stop), std::ref(active)));
+    }
+
+    // recorders are created on the first 'v' and paused by '0': one for the mosaic, or one per camera
+    const int fourcc = cv::VideoWriter::fourcc('M', 'J', 'P', 'G');
+    std::unique_ptr<VideoRecorder> mosaicVideo;
+    bool isSavingVideo = false;
+    bool showStats = false;
+    const cv::Size grid = mosaicGrid(cameras.size());
+    // the recorded mosaic, and the one shown with the overlays when 'i' is on
+    cv::Mat wall, shownWall;
+    cv::Size tileSize;
+
+    // display/encode stays on this thread, HighGUI wants the main thread
+    for (;;) {
+        // read before popping so the last processed frames are still shown
+        bool finished = active == 0;
+        bool fresh = false;
+        for (size_t i = 0; i < cameras.size(); i++) {
+            CameraPipeline &cam = *cameras[i];
+            PipelineFrame item;
+            bool got = false;
+            while (cam.processed.tryPop(item)) {
+                got = true;
+            }
+            if (!got) {
+                continue;
+            }
+            fresh = true;
+            if (isSavingVideo && !mosaic) {
+                cam.video->write(item.frame, item.timestamp);
+            }
+            // the recorders still read item.frame on their threads, so the overlay
+            // goes on a copy that is only shown and never ends up in the files
+            cv::Mat display = item.frame;
+            if (showStats) {
+                display = item.frame.clone();
+                cam.stats->drawOverlay(display);
+            }
+            double now = secondsNow();
+            cam.stats->record("latency", (now - item.timestamp) * 1000.0);
+            cam.stats->frameShown(now);
+            cam.shown = item.frame;
+            if (mosaic) {
+                if (wall.empty()) {
+                    // tiles take the shape of the first frame, scaled so the grid fits mosaicWidth
+                    const int width = std::min(item.frame.cols, mosaicWidth / grid.width);
+                    tileSize = cv::Size(width, std::max(1, item.frame.rows * width / item.frame.cols));
+                    wall = cv::Mat::zeros(tileSize.height * grid.height, tileSize.width * grid.width, CV_8UC3);
+                }
+                StageTimer timer(cam.stats.get(), "mosaic");
+                const cv::Rect tile((int)(i % grid.width) * tileSize.width, (int)(i / grid.width) * tileSize.height,
+                                    tileSize.width, tileSize.height);
+                drawTile(wall, tile, item.frame);
+                if (showStats) {
+                    if (shownWall.empty()) {
+                        shownWall = wall.clone();
+                    }
+                    drawTile(shownWall, tile, display);
+                }
+            }
+            else {
+                StageTimer timer(cam.stats.get(), "display");
+                cv::imshow("Camera " + std::to_string(i), display);
+            }
         }
-        else if (key == 'f') {
-            lastKeypress = 'f';
-            cout << lastKeypress << "pressed : Using face detect." << endl;
+        if (fresh && mosaic) {
+            if (isSavingVideo) {
+                mosaicVideo->write(wall.clone(), secondsNow());
+            }
+            cv::imshow("Cameras", showStats ? shownWall : wall);
         }
-        else if (key == 'c') {
-            lastKeypress = 'c';
-            cout << lastKeypress << "pressed : Make face colorful." << endl;
+        if (finished && !fresh) {
+            break;
         }
-        else if (key == 'a') {
-            lastKeypress = 'a';
-            cout << lastKeypress << "pressed : Make background blur." << endl;
+
+        char key = cv::waitKey(1);
+        if (key == 'q') {
+            break;
         }
-        else if (key == 'n') {
-            lastKeypress = 'n';
-            cout << lastKeypress << "pressed : Make negative image." << endl;
+        else if (key == 's') {
+            cout << key << " pressed: Saving frames to captured_frame_<n>.png." << endl;
+            for (size_t i = 0; i < cameras.size(); i++) {
+                if (!cameras[i]->shown.empty()) {
+                    cv::imwrite("captured_frame_" + std::to_string(i) + ".png", cameras[i]->shown);
+                }
+            }
+        }
+        else if (key == 'i') {
+            showStats = !showStats;
+            // tiles drawn while the overlay was off are only in wall
+            shownWall = wall.clone();
+            cout << key << " pressed: " << (showStats ? "Showing" : "Hiding") << " frame timing." << endl;
         }
-        else if (key == 'e') {
-            lastKeypress = 'e';
-            cout << lastKeypress << "pressed : Make embossing effect." << endl;
+        else if (key == 'u') {
+            adaptive = !adaptive;
+            cout << key << " pressed: Adaptive quality " << (adaptive ? "on" : "off (always full quality)") << "." << endl;
         }
-        else if (key == 'z') {
-            lastKeypress = 'z';
-            cout << lastKeypress << "pressed : Make comic book effect." << endl;
+        else if (key == '+') {
+            stacking = !stacking;
+            cout << key << " pressed: " << (stacking ? "Stacking effects." : "Effects replace each other.") << endl;
         }
         else if (key == 'v') {
-            lastKeypress = 'v';
-            cout << lastKeypress << "pressed : Video saving started." << endl;
+            if (mosaic && !mosaicVideo) {
+                mosaicVideo.reset(new VideoRecorder("out.avi", fourcc));
+            }
+            for (size_t i = 0; i < cameras.size() && !mosaic; i++) {
+                if (!cameras[i]->video) {
+                    cameras[i]->video.reset(new VideoRecorder("out_" + std::to_string(i) + ".avi", fourcc));
+                    cameras[i]->video->setStats(cameras[i]->stats.get(), "encode");
+                }
+            }
+            isSavingVideo = true;
+            cout << key << " pressed: Video saving started." << endl;
         }
         else if (key == '0') {
-            lastKeypress = '0';
-            cout << lastKeypress << "pressed : Video saving stopped." << endl;
+            if (isSavingVideo) {
+                if (mosaicVideo) {
+                    mosaicVideo->pause();
+                }
+                for (size_t i = 0; i < cameras.size(); i++) {
+                    if (cameras[i]->video) {
+                        cameras[i]->video->pause();
+                    }
+                }
+            }
+            isSavingVideo = false;
+            cout << key << " pressed: Video saving stopped." << endl;
+        }
+        else {
+            for (size_t i = 0; i < sizeof(effectKeys) / sizeof(effectKeys[0]); i++) {
+                if (key != effectKeys[i].key) {
+                    continue;
+                }
+                cout << key << " pressed: " << effectKeys[i].message << endl;
+                std::string next = effectKeys[i].spec;
+                if (stacking && key != 'o' && !chain.empty()) {
+                    next = chain + ">" + next;
+                }
+                if (selectEffect(selection, next)) {
+                    chain = next;
+                }
+                break;
+            }
         }
     }
 
+    stop = true;
+    for (size_t i = 0; i < cameras.size(); i++) {
+        cameras[i]->capture.join();
+    }
+    for (size_t w = 0; w < pool.size(); w++) {
+        pool[w].join();
+    }
+    setFilterThreads(filterThreads);
+
+    if (mosaicVideo) {
+        mosaicVideo->stop();
+        printf("out.avi: %zu frames written (%zu repeated), %zu dropped, %zu skipped, %.2f fps\n",
+               mosaicVideo->framesWritten(), mosaicVideo->framesRepeated(), mosaicVideo->framesDropped(),
+               mosaicVideo->framesSkipped(), mosaicVideo->fps());
+    }
+    for (size_t i = 0; i < cameras.size(); i++) {
+        CameraPipeline &cam = *cameras[i];
+        printf("\nSource %zu (%s): %zu frames processed, %zu dropped before processing, %zu before display\n", i,
+               cam.source->describe().c_str(), cam.frames, cam.captured.dropped(), cam.processed.dropped());
+        if (cam.video) {
+            cam.video->stop();
+            printf("out_%zu.avi: %zu frames written (%zu repeated), %zu dropped, %zu skipped, %.2f fps\n", i,
+                   cam.video->framesWritten(), cam.video->framesRepeated(), cam.video->framesDropped(),
+                   cam.video->framesSkipped(), cam.video->fps());
+        }
+        cam.controller->printSummary();
+        cam.stats->printSummary();
+    }
     return 0;
 }
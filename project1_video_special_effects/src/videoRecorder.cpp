@@ -0,0 +1,230 @@
+/**
+ * author: Harshit Kumar and Khushi Neema
+ * date: Oct 17, 2026
+ * purpose: Records frames to a video file on a background encoder thread.
+ *
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include "videoRecorder.h"
+
+// frames (or seconds of input) used to measure the frame rate before opening the file
+static const size_t warmupFrames = 30;
+static const double warmupSeconds = 1.0;
+
+// used when the recording is too short to measure anything
+static const double defaultFps = 30.0;
+
+VideoRecorder::VideoRecorder(const std::string &path, int fourcc, size_t queueSize)
+    : path(path), fourcc(fourcc), queue(queueSize), stopping(false), paused(false),
+      stats(NULL), statsStage(""), failed(false), warmupBegin(0), timeOrigin(0), frameIndex(0), written(0), repeated(0),
+      dropped(0), skipped(0), measuredFps(0)
+{
+    encoder = std::thread(&VideoRecorder::encodeLoop, this);
+}
+
+VideoRecorder::~VideoRecorder()
+{
+    stop();
+}
+
+bool VideoRecorder::write(const cv::Mat &frame, double timestamp)
+{
+    if (stopping || frame.empty())
+    {
+        return false;
+    }
+
+    TimedFrame item;
+    item.frame = frame;
+    item.timestamp = timestamp;
+    item.resume = paused.exchange(false);
+    if (!queue.tryPush(item))
+    {
+        // never wait for the encoder, the caller is the live video loop
+        dropped++;
+        if (item.resume)
+        {
+            paused = true;
+        }
+        return false;
+    }
+    return true;
+}
+
+void VideoRecorder::pause()
+{
+    paused = true;
+}
+
+void VideoRecorder::setStats(FrameStats *stats, const char *stage)
+{
+    statsStage = stage;
+    this->stats = stats;
+}
+
+void VideoRecorder::stop()
+{
+    stopping = true;
+    if (encoder.joinable())
+    {
+        encoder.join();
+    }
+}
+
+void VideoRecorder::encodeLoop()
+{
+    for (;;)
+    {
+        // read the flag before popping so frames queued before stop() are still written
+        bool finishing = stopping;
+        TimedFrame item;
+        if (queue.tryPop(item))
+        {
+            encode(item);
+        }
+        else if (finishing)
+        {
+            break;
+        }
+        else
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+
+    // a recording shorter than the warmup still gets its file
+    if (!writer.isOpened() && !warmup.empty())
+    {
+        openWriter();
+    }
+    writer.release();
+}
+
+void VideoRecorder::encode(TimedFrame &item)
+{
+    if (failed)
+    {
+        // the file could not be opened, the frames still queued go nowhere
+        dropped++;
+        return;
+    }
+
+    // the writer is opened for 8-bit BGR frames, greyscale effects are expanded here
+    if (item.frame.channels() == 1)
+    {
+        cv::cvtColor(item.frame, item.frame, cv::COLOR_GRAY2BGR);
+    }
+    if (item.frame.depth() != CV_8U)
+    {
+        cv::convertScaleAbs(item.frame, item.frame);
+    }
+
+    if (writer.isOpened())
+    {
+        writeTimed(item);
+        return;
+    }
+
+    if (item.resume && warmupBegin < warmup.size())
+    {
+        // a pause inside the warmup: the frames since the last pause measure the rate if
+        // there are two of them, otherwise the measurement starts over with this frame
+        if (warmup.back().timestamp > warmup[warmupBegin].timestamp)
+        {
+            openWriter();
+            encode(item);
+            return;
+        }
+        warmupBegin = warmup.size();
+    }
+
+    warmup.push_back(item);
+    if (warmup.size() - warmupBegin >= warmupFrames || item.timestamp - warmup[warmupBegin].timestamp >= warmupSeconds)
+    {
+        openWriter();
+    }
+}
+
+void VideoRecorder::openWriter()
+{
+    // frame rate from the capture timestamps of the warmup frames, the ones since the
+    // last pause (the time between frames across a pause says nothing about the rate)
+    double fps = defaultFps;
+    const size_t count = warmup.size() - warmupBegin;
+    double span = warmup.back().timestamp - warmup[warmupBegin].timestamp;
+    if (count > 1 && span > 0)
+    {
+        fps = std::min(240.0, std::max(1.0, (count - 1) / span));
+    }
+    measuredFps = fps;
+
+    frameSize = warmup.front().frame.size();
+    if (!writer.open(path, fourcc, fps, frameSize))
+    {
+        // stop taking frames, the ones collected so far count as dropped
+        printf("Unable to open %s for recording, recording stopped\n", path.c_str());
+        failed = true;
+        stopping = true;
+        measuredFps = 0;
+        dropped += warmup.size();
+        warmup.clear();
+        warmupBegin = 0;
+        return;
+    }
+    printf("Recording %s at %dx%d, %.2f fps\n", path.c_str(), frameSize.width, frameSize.height, fps);
+
+    // the frames after a pause carry its resume flag, so the paused time is not filled
+    timeOrigin = warmup.front().timestamp;
+    frameIndex = 0;
+    for (size_t i = 0; i < warmup.size(); i++)
+    {
+        writeTimed(warmup[i]);
+    }
+    warmup.clear();
+    warmupBegin = 0;
+}
+
+void VideoRecorder::writeTimed(const TimedFrame &item)
+{
+    const double fps = measuredFps;
+    cv::Mat frame = item.frame;
+    if (frame.size() != frameSize)
+    {
+        cv::resize(frame, frame, frameSize);
+    }
+
+    if (item.resume)
+    {
+        // continue right after the last written frame instead of filling the pause
+        timeOrigin = item.timestamp - frameIndex / fps;
+    }
+
+    long long target = std::llround((item.timestamp - timeOrigin) * fps);
+    if (target < (long long)frameIndex)
+    {
+        // ahead of the timeline (input faster than the file rate), skip this one
+        lastFrame = frame;
+        skipped++;
+        return;
+    }
+
+    // repeat the previous frame over time the input skipped
+    while ((long long)frameIndex < target && !lastFrame.empty())
+    {
+        writer.write(lastFrame);
+        frameIndex++;
+        written++;
+        repeated++;
+    }
+
+    {
+        StageTimer timer(stats, statsStage);
+        writer.write(frame);
+    }
+    frameIndex++;
+    written++;
+    lastFrame = frame;
+}
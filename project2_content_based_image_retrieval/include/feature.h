@@ -11,6 +11,8 @@
 
 #include <opencv2/opencv.hpp>
 #include <opencv2/core/core.hpp>
+// sobelX3x3(), sobelY3x3() and magnitude() are the shared ones
+#include "imageKernels.h"
 
 /**
  * @brief Compute features of an image
@@ -55,32 +57,6 @@ std::pair<cv::Mat, cv::Mat> computeSpatialHistograms(const cv::Mat &image, int b
  */
 std::pair<cv::Mat, cv::Mat> computeSpatialHistograms_texture(const cv::Mat &image, int bins);
 
-/*
- * @brief Applies SobelX filter (horizontal edge detection) to an image
- * @param src Input image
- * @param dst Output image
- * @return 0 if the operation is succesful.
- */
-
-int sobelX3x3(cv::Mat &src, cv::Mat &dst);
-
-/*
- * @brief Applies SobelY filter (vertical edge detection) to an image
- * @param src Input image
- * @param dst Output image
- * @return 0 if the operation is succesful.
- */
-int sobelY3x3(cv::Mat &src, cv::Mat &dst);
-
-/**
- * @brief generates a gradient magnitude to an image.
- * @param sobelX Input image.
- * @param sobelY Input image.
- * @param dst Output image.
- * @return 0 if the operation is successful.
- */
-int magnitude(cv::Mat &sobelX, cv::Mat &sobelY, cv::Mat &dst);
-
 /**
  * @brief generates a gradient magnitude to an image.
  * @param image Input image.
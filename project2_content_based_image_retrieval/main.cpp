@@ -33,6 +33,7 @@ int main(int argc, char *argv[])
 {
 
     cout << "Suported feature types: baseline, histogram, multihistogram, dnn, texture, gabor, grass, bluebins" << endl;
+    cout << "Image kernels: " << describeImageKernels() << endl;
 
     char dirname[256];
     char buffer[256];
@@ -330,136 +330,6 @@ std::pair<cv::Mat, cv::Mat> computeSpatialHistograms_gabor(const cv::Mat &image,
     return {topHist, bottomHist};
 }
 
-int sobelX3x3(cv::Mat &src, cv::Mat &dst)
-{
-    cv::Mat temp = src.clone();
-    dst = cv::Mat::zeros(src.size(), CV_16SC3);
-
-    // horizontal filter
-    for (int i = 0; i < src.rows; i++)
-    {
-        cv::Vec3b *tempptr = temp.ptr<cv::Vec3b>(i);
-        cv::Vec3b *rowptr = src.ptr<cv::Vec3b>(i);
-        for (int j = 1; j < src.cols - 1; j++)
-        {
-            for (int c = 0; c < 3; c++)
-            {
-                tempptr[j][c] = static_cast<uchar>(
-                    (-1 * rowptr[j - 1][c] +
-                     1 * rowptr[j + 1][c]) /
-                        2.0 +
-                    0.5);
-            }
-        }
-    }
-
-    // vertical filter
-    for (int i = 1; i < src.rows - 1; i++)
-    {
-        cv::Vec3s *dptr = dst.ptr<cv::Vec3s>(i);
-        cv::Vec3b *tempptrm1 = temp.ptr<cv::Vec3b>(i - 1);
-        cv::Vec3b *tempptr = temp.ptr<cv::Vec3b>(i);
-        cv::Vec3b *tempptrp1 = temp.ptr<cv::Vec3b>(i + 1);
-        for (int j = 0; j < src.cols; j++)
-        {
-            for (int c = 0; c < 3; c++)
-            {
-                dptr[j][c] = static_cast<short>(
-                    (1 * tempptrm1[j][c] +
-                     2 * tempptr[j][c] +
-                     1 * tempptrp1[j][c]) /
-                        4.0 +
-                    0.5);
-            }
-        }
-    }
-    // cv::normalize(dst, dst, 0, 255, cv::NORM_L1);
-
-    return 0;
-}
-
-int sobelY3x3(cv::Mat &src, cv::Mat &dst)
-{
-    cv::Mat temp = src.clone();
-    dst = cv::Mat::zeros(src.size(), CV_16SC3);
-
-    // vertical filter
-    for (int i = 1; i < src.rows - 1; i++)
-    {
-        cv::Vec3b *tempptr = temp.ptr<cv::Vec3b>(i);
-        cv::Vec3b *rowptrm1 = src.ptr<cv::Vec3b>(i - 1);
-        cv::Vec3b *rowptrp1 = src.ptr<cv::Vec3b>(i + 1);
-        for (int j = 0; j < src.cols; j++)
-        {
-            for (int c = 0; c < 3; c++)
-            {
-                tempptr[j][c] = static_cast<uchar>(
-                    (-1 * rowptrm1[j][c] +
-                     1 * rowptrp1[j][c]) /
-                        2.0 +
-                    0.5);
-            }
-        }
-    }
-
-    // horizontal filter
-    for (int i = 0; i < src.rows; i++)
-    {
-        cv::Vec3s *dptr = dst.ptr<cv::Vec3s>(i);
-        cv::Vec3b *tempptr = temp.ptr<cv::Vec3b>(i);
-        for (int j = 1; j < src.cols - 1; j++)
-        {
-            for (int c = 0; c < 3; c++)
-            {
-                dptr[j][c] = static_cast<short>(
-                    (1 * tempptr[j - 1][c] +
-                     2 * tempptr[j][c] +
-                     1 * tempptr[j + 1][c]) /
-                        4.0 +
-                    0.5);
-            }
-        }
-    }
-    // cv::normalize(dst, dst, 0, 255, cv::NORM_L1);
-
-    return 0;
-}
-
-int magnitude(cv::Mat &sobelX, cv::Mat &sobelY, cv::Mat &dst)
-{
-    dst = cv::Mat::zeros(sobelX.size(), CV_8UC3);
-
-    // loop over columns
-    for (int i = 0; i < sobelX.rows; i++)
-    {
-
-        // src row pointers
-        cv::Vec3s *sobelXrowptr = sobelX.ptr<cv::Vec3s>(i);
-        cv::Vec3s *sobelYrowptr = sobelY.ptr<cv::Vec3s>(i);
-
-        // destination ptr
-        cv::Vec3b *dptr = dst.ptr<cv::Vec3b>(i);
-
-        // loop over columns
-        for (int j = 0; j < sobelX.cols; j++)
-        {
-            double magnitude = sqrt(sobelXrowptr[j][0] * sobelXrowptr[j][0] + sobelYrowptr[j][0] * sobelYrowptr[j][0]);
-            magnitude = std::min(255.0, std::max(0.0, magnitude)); // Ensure magnitude is within [0, 255]
-            // loop over color channels
-            for (int c = 0; c < 3; c++)
-            {
-
-                // std::cout<< "Magnitude: "<<magnitude<<std::endl;
-                dptr[j][c] = static_cast<uchar>(magnitude);
-            }
-        }
-
-        // cv::normalize(dst, dst, 0, 255, cv::NORM_L1);
-    }
-
-    return 0;
-}
-
 cv::Mat orientation(cv::Mat &image, cv::Mat sx, cv::Mat sy)
 {
     // calculate sobelX and sobelY
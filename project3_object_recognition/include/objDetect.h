@@ -21,6 +21,8 @@
 #define OBJ_DETECT_H
 
 #include <opencv2/opencv.hpp>
+// blur5x5_2() is the shared one
+#include "imageKernels.h"
 
 /**
  * @brief Struct to store the features of an object
@@ -33,15 +35,6 @@ struct ObjectFeatures
     cv::Mat dnnEmbedding; // DNN embedding vector
 };
 
-/**
- * @brief Apply 5x5 Gaussian blur to the input image
- *
- * @param src input image
- * @param dst output image
- * @return int
- */
-int blur5x5_2(cv::Mat &src, cv::Mat &dst);
-
 /**
  * @brief Calculate the dynamic threshold using k-means clustering algorithm
  *
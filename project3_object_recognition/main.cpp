@@ -12,12 +12,22 @@
 #include <iostream>
 #include <fstream>
 #include "objDetect.h"
+#include "frameSource.h"
 
 using namespace cv;
 using namespace std;
 
-int main()
+int main(int argc, char **argv)
 {
+    // the default camera unless --source picks a file, image directory or pattern (e.g. blobs)
+    FrameSourceOptions sourceOptions;
+    if (parseFrameSourceArgs(argc, argv, sourceOptions) != 0 || argc > 1)
+    {
+        std::cout << "usage: " << argv[0] << " " << frameSourceUsage() << std::endl;
+        return -1;
+    }
+    std::cout << "Image kernels: " << describeImageKernels() << std::endl;
+
     // type of embedding to use
     std::string embeddingType = "default"; // "default" or "dnn"
     // database file
@@ -37,12 +47,13 @@ int main()
             return -1;
         }
     }
-    // to open a default camera
-    cv::VideoCapture cap(0);
+    // to open the camera (or other frame source)
+    std::unique_ptr<FrameSource> source;
+    std::string sourceError;
     cv::Mat frame, blur, hsv;
-    if (!cap.isOpened())
+    if (openFrameSource(sourceOptions, source, &sourceError) != 0)
     {
-        printf("Error opening the default camera");
+        printf("Error opening the frame source: %s\n", sourceError.c_str());
         return -1;
     }
     cv::namedWindow("Original Video", WINDOW_NORMAL);
@@ -55,11 +66,16 @@ int main()
         char key = cv::waitKey(10);
 
         // cv::Mat frame;
-        cap >> frame;
-        if (frame.empty())
+        if (!source->read(frame))
         {
-            std::cout << "Error: Blank frame grabbed" << std::endl;
-            continue;
+            // a camera can miss a frame and go on, the other sources have run out
+            if (source->isLive())
+            {
+                std::cout << "Error: Blank frame grabbed" << std::endl;
+                continue;
+            }
+            std::cout << "End of input" << std::endl;
+            break;
         }
 
         // 1. Preprocess and threshold the frame
@@ -264,7 +280,6 @@ int main()
         }
     }
 
-    cap.release();
     cv::destroyAllWindows();
     return 0;
 }
\ No newline at end of file
@@ -17,63 +17,6 @@
 using namespace std;
 using namespace cv;
 
-int blur5x5_2(cv::Mat &src, cv::Mat &dst)
-{
-    dst = cv::Mat::zeros(src.size(), src.type());
-    cv::Mat temp = cv::Mat::zeros(src.size(), src.type());
-
-    // row filter
-    for (int i = 2; i < src.rows - 2; i++)
-    {
-        cv::Vec3b *rowptr = src.ptr<cv::Vec3b>(i);
-        cv::Vec3b *tempptr = temp.ptr<cv::Vec3b>(i);
-
-        // loop over columns
-        for (int j = 2; j < src.cols - 2; j++)
-        {
-            // loop over color channels
-            for (int c = 0; c < 3; c++)
-            {
-                // row filter [1 , 2, 4, 2, 1]
-                tempptr[j][c] = (1 * rowptr[j - 2][c] + 2 * rowptr[j - 1][c] + 4 * rowptr[j][c] + 2 * rowptr[j + 1][c] + 1 * rowptr[j + 2][c]) / 10.0;
-            }
-        }
-    }
-
-    // column filter
-    for (int i = 2; i < src.rows - 2; i++)
-    {
-        cv::Vec3b *rowptrm2 = temp.ptr<cv::Vec3b>(i - 2);
-        cv::Vec3b *rowptrm1 = temp.ptr<cv::Vec3b>(i - 1);
-        cv::Vec3b *rowptr = temp.ptr<cv::Vec3b>(i);
-        cv::Vec3b *rowptrp1 = temp.ptr<cv::Vec3b>(i + 1);
-        cv::Vec3b *rowptrp2 = temp.ptr<cv::Vec3b>(i + 2);
-
-        cv::Vec3b *dptr = dst.ptr<cv::Vec3b>(i);
-
-        // loop over columns
-        for (int j = 2; j < src.cols - 2; j++)
-        {
-            // loop over color channels
-            for (int c = 0; c < 3; c++)
-            {
-                /*column filter
-                    [1]  m2
-                    [2]  m1
-                    [4]  r
-                    [2]  p1
-                    [1]  p2
-                */
-                dptr[j][c] = (1 * rowptrm2[j][c] + 2 * rowptrm1[j][c] + 4 * rowptr[j][c] + 2 * rowptrp1[j][c] + 1 * rowptrp2[j][c]) / 10.0;
-                // clip b/w 0 and 255
-                dptr[j][c] = dptr[j][c] > 255 ? 255 : dptr[j][c];
-            }
-        }
-    }
-
-    return 0; // Success
-}
-
 double calculateDynamicThreshold(const Mat &src, int k)
 {
     // Reshape the image to a 1D array of pixels
@@ -1,6 +1,7 @@
 #include <opencv2/opencv.hpp>
 #include <iostream>
 #include <vector>
+#include "frameSource.h"
 
 using namespace cv;
 using namespace std;
@@ -79,7 +80,14 @@ void augmentReality(const Mat& frame, const vector<Point2f>& pts) {
 }
 
 
-int main() {
+int main(int argc, char** argv) {
+    // the default camera unless --source picks a file or image directory
+    FrameSourceOptions sourceOptions;
+    if (parseFrameSourceArgs(argc, argv, sourceOptions) != 0 || argc > 1) {
+        cout << "usage: " << argv[0] << " " << frameSourceUsage() << endl;
+        return -1;
+    }
+
     // Load the target image (the non-checkerboard target you want to detect)
     Mat targetImage = imread("/Users/harshit/Downloads/IMG_2372.jpeg", IMREAD_GRAYSCALE);
     if (targetImage.empty()) {
@@ -101,9 +109,10 @@ int main() {
     BFMatcher matcher(NORM_HAMMING);
 
     // Start capturing video
-    VideoCapture cap(0);
-    if (!cap.isOpened()) {
-        cout << "Error opening video stream." << endl;
+    std::unique_ptr<FrameSource> source;
+    std::string sourceError;
+    if (openFrameSource(sourceOptions, source, &sourceError) != 0) {
+        cout << "Error opening video stream: " << sourceError << endl;
         return -1;
     }
 
@@ -112,8 +121,7 @@ int main() {
     Mat descriptorsFrame;
 
     while (true) {
-        cap >> frame;
-        if (frame.empty())
+        if (!source->read(frame))
             break;
 
         // Convert frame to grayscale because ORB works with grayscale images
@@ -7,15 +7,22 @@
 
 #include <opencv2/opencv.hpp>
 #include <iostream>
+#include "frameSource.h"
 
 using namespace cv;
 using std::vector;
 
-int main() {
-    // Open the default video camera
-    VideoCapture cap(0);
-    if (!cap.isOpened()) {
-        std::cerr << "Error opening video stream" << std::endl;
+int main(int argc, char** argv) {
+    // Open the default video camera, or the source given by --source (e.g. chessboard)
+    FrameSourceOptions sourceOptions;
+    if (parseFrameSourceArgs(argc, argv, sourceOptions) != 0 || argc > 1) {
+        std::cerr << "usage: " << argv[0] << " " << frameSourceUsage() << std::endl;
+        return -1;
+    }
+    std::unique_ptr<FrameSource> source;
+    std::string sourceError;
+    if (openFrameSource(sourceOptions, source, &sourceError) != 0) {
+        std::cerr << "Error opening video stream: " << sourceError << std::endl;
         return -1;
     }
 
@@ -29,8 +36,7 @@ int main() {
 
     Mat frame;
     while (true) {
-        cap >> frame; // Capture frame-by-frame
-        if (frame.empty())
+        if (!source->read(frame)) // Capture frame-by-frame
             break;
 
         Mat gray;
@@ -60,8 +66,6 @@ int main() {
         if (waitKey(30) >= 0) break; // Wait for a keystroke in the window
     }
 
-    // When everything done, release the video capture object
-    cap.release();
     destroyAllWindows();
     return 0;
 }
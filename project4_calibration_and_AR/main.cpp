@@ -5,20 +5,28 @@
 #include <opencv2/imgproc.hpp>
 #include <opencv2/calib3d.hpp>
 #include "chessboardcorner.h"
+#include "frameSource.h"
 
 using namespace std;
 using namespace cv;
 
 int main(int argc, char** argv)
 {
+    // the default camera unless --source picks a file, image directory or the chessboard pattern
+    FrameSourceOptions sourceOptions;
+    if(parseFrameSourceArgs(argc, argv, sourceOptions) != 0 || argc > 1){
+        std::cout << "usage: " << argv[0] << " " << frameSourceUsage() << std::endl;
+        return -1;
+    }
      // Wait for a keystroke in the window
-    cv::VideoCapture capdev(0);
+    std::unique_ptr<FrameSource> source;
+    std::string sourceError;
     cv::Mat frame;
     cv::Size boardSize(9,6);
     cv::namedWindow("Display Window",WINDOW_NORMAL);
     
-    if(!capdev.isOpened()){
-        printf("Unable to open the video camera");
+    if(openFrameSource(sourceOptions, source, &sourceError) != 0){
+        printf("Unable to open the frame source: %s\n", sourceError.c_str());
         return -1;
     }
     std::vector<cv::Point2f> corner_set;
@@ -34,14 +42,13 @@ int main(int argc, char** argv)
     int flag=0;
     while(true)
     {
-        capdev >> frame;
+        if(!source->read(frame)){
+            printf("End of input\n");
+            break;
+        }
         camera_matrix.at<double>(0,2)=frame.cols/2;
         camera_matrix.at<double>(1,2)=frame.rows/2;
         char k = waitKey(10);
-        if(frame.empty()){
-            printf("Blank Frame grabbed");
-            return -1;
-        }
         //Task 1
         bool foundCorners = drawchessboardcorner(frame,boardSize, corner_set);      //to find and display chessboard corners
 
@@ -96,7 +103,6 @@ int main(int argc, char** argv)
             break;
         }
     }
-    capdev.release();
     cv::destroyAllWindows();
     return 0;
 }
\ No newline at end of file
@@ -12,6 +12,7 @@
 #include <opencv2/imgproc.hpp>
 #include <opencv2/calib3d.hpp>
 #include "chessboardcorner.h"
+#include "frameSource.h"
 
 using namespace std;
 using namespace cv;
@@ -29,9 +30,16 @@ std::vector<cv::Point3f> generate3DChessboardCorners(cv::Size boardSize, float s
 
 
 int main(int argc, char** argv) {
-    cv::VideoCapture capdev(0);
-    if (!capdev.isOpened()) {
-        std::cerr << "Unable to open the video camera" << std::endl;
+    // the default camera unless --source picks a file, image directory or the chessboard pattern
+    FrameSourceOptions sourceOptions;
+    if (parseFrameSourceArgs(argc, argv, sourceOptions) != 0 || argc > 1) {
+        std::cerr << "usage: " << argv[0] << " " << frameSourceUsage() << std::endl;
+        return -1;
+    }
+    std::unique_ptr<FrameSource> source;
+    std::string sourceError;
+    if (openFrameSource(sourceOptions, source, &sourceError) != 0) {
+        std::cerr << "Unable to open the frame source: " << sourceError << std::endl;
         return -1;
     }
 
@@ -55,9 +63,8 @@ int main(int argc, char** argv) {
     fs.release();
 
     while (true) {
-        capdev >> frame;
-        if (frame.empty()) {
-            std::cerr << "Blank Frame grabbed" << std::endl;
+        if (!source->read(frame)) {
+            std::cerr << "End of input" << std::endl;
             break;
         }
 
@@ -93,7 +100,6 @@ int main(int argc, char** argv) {
         }
     }
 
-    capdev.release();
     cv::destroyAllWindows();
     return 0;
 }